@@ -0,0 +1,412 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include "dataset_generator.h"
+#include "sighting_search.h"
+
+// One measured (strategy, dataset) pair
+struct BenchResult
+{
+    std::string strategy;
+    int sightings;
+    size_t uniqueSightings;
+    int signatures;
+    int seed;
+    unsigned threads;
+    int iterations;
+    int matches;
+    double medianUs;
+    double p99Us;
+};
+
+typedef std::function<int(std::vector<int> &, std::vector<int> &)> Strategy;
+
+/*
+Name        : parseList
+Description : Splits a comma separated list of integers, such as "1000,10000"
+Receives    : the list, vector to fill
+Returns     : false if an element is not a positive integer (or zero, for seeds).
+*/
+bool parseList(const std::string &text, std::vector<int> &values)
+{
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        size_t used = 0;
+        int value = 0;
+        try
+        {
+            value = std::stoi(item, &used);
+        }
+        catch (...)
+        {
+            return false;
+        }
+        if (used != item.size() || value < 0)
+        {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+/*
+Name        : makeStrategy
+Description : Wraps one search engine of sighting_search.h, including the sort it needs, as the tool runs it
+Receives    : engine name, the pool (nullptr for the serial engines)
+Returns     : The strategy, or an empty function if the name is unknown.
+*/
+Strategy makeStrategy(const std::string &name, ThreadPool *pool)
+{
+    if (name == "linear-scalar")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { return parallelLinearSearch(a, b, *pool, linearKernel(kSimdScalar)); };
+        return [](std::vector<int> &a, std::vector<int> &b) { return linearsearch(a, b); };
+    }
+    if (name == "linear")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { return parallelLinearSearch(a, b, *pool, linearKernel()); };
+        return [](std::vector<int> &a, std::vector<int> &b) { return simdLinearSearch(a, b, linearKernel()); };
+    }
+    if (name == "binary")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { parallelSort(a, *pool); return parallelBinSearch(a, b, *pool); };
+        return [](std::vector<int> &a, std::vector<int> &b) { std::sort(a.begin(), a.end()); return binSearch(a, b); };
+    }
+    if (name == "eytzinger")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { parallelSort(a, *pool); return parallelEytzingerSearch(a, b, *pool); };
+        return [](std::vector<int> &a, std::vector<int> &b) { std::sort(a.begin(), a.end()); return eytzingerSearch(a, b); };
+    }
+    if (name == "packed")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { parallelSort(a, *pool); return parallelPackedSearch(a, b, *pool); };
+        return [](std::vector<int> &a, std::vector<int> &b) { std::sort(a.begin(), a.end()); return packedSearch(a, b); };
+    }
+    if (name == "bitmap")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { return parallelBitmapSearch(a, b, *pool); };
+        return [](std::vector<int> &a, std::vector<int> &b) { return bitmapSearch(a, b); };
+    }
+    if (name == "radix")
+    {
+        if (pool)
+            return [pool](std::vector<int> &a, std::vector<int> &b) { return parallelRadixJoinSearch(a, b, *pool); };
+        return [](std::vector<int> &a, std::vector<int> &b) { return radixJoinSearch(a, b); };
+    }
+    return Strategy();
+}
+
+/*
+Name        : runStrategy
+Description : Runs @strategy @warmup times untimed, then @iterations times timed. Every run gets fresh copies
+              of the inputs since the engines sort them in place; the copy is not timed.
+Receives    : the strategy, unique sightings, signatures, warmup and timed run counts, result to fill
+Returns     : nothing, fills matches, median and p99 of @result.
+*/
+void runStrategy(const Strategy &strategy, const std::vector<int> &sightings, const std::vector<int> &signatures,
+                 int warmup, int iterations, BenchResult &result)
+{
+    Time clock;
+    std::vector<double> times;
+    for (int run = 0; run < warmup + iterations; run++)
+    {
+        std::vector<int> a = sightings;
+        std::vector<int> b = signatures;
+        clock.Reset();
+        result.matches = strategy(a, b);
+        double elapsed = clock.CurrentTime();
+        if (run >= warmup)
+        {
+            times.push_back(elapsed);
+        }
+    }
+    std::sort(times.begin(), times.end());
+    result.medianUs = times[times.size() / 2];
+    size_t p99 = (times.size() * 99 + 99) / 100;
+    result.p99Us = times[std::max<size_t>(p99, 1) - 1];
+}
+
+/*
+Name        : checkApprox
+Description : Validation of sighting_search --approx: runs the estimate @trials times on one dataset, each
+              time on other blocks of both sides (sampled the way a binary dataset is), and checks the
+              exact count against the reported interval. One summary line goes to stderr.
+Receives    : every sighting signature (duplicates kept, in file order), signatures, exact count, sample
+              rate, confidence level, number of trials, seed of the first trial
+Returns     : Number of trials whose interval held the exact count.
+*/
+int checkApprox(const std::vector<int> &records, const std::vector<int> &signatures, int exact, double rate,
+                double confidence, int trials, int seed)
+{
+    Time clock;
+    int covered = 0;
+    double error = 0, width = 0, elapsed = 0;
+    for (int trial = 0; trial < trials; trial++)
+    {
+        clock.Reset();
+        MatchEstimator estimator;
+        uint32_t draw = static_cast<uint32_t>(seed) * 2654435761u + 2 * trial;
+        double signatureFraction = forEachSampledRecord(signatures.data(), signatures.size(), rate, draw,
+                                                        [&](int v) { estimator.AddSignature(v); });
+        double sightingFraction = forEachSampledRecord(records.data(), records.size(), rate, draw + 1,
+                                                       [&](int v) { estimator.AddSighting(v); });
+        MatchEstimate estimate = estimator.Estimate(sightingFraction, signatureFraction, confidence);
+        elapsed += clock.CurrentTime();
+        covered += estimate.low <= exact && exact <= estimate.high;
+        error += std::fabs(estimate.count - exact) / std::max(exact, 1);
+        width += (estimate.high - estimate.low) / std::max(exact, 1);
+    }
+    std::cerr << "approx: sightings=" << records.size() << " signatures=" << signatures.size() << " seed=" << seed
+              << " rate=" << rate << " exact=" << exact << " covered=" << covered << "/" << trials
+              << " mean_error=" << 100 * error / trials << "% mean_width=" << 100 * width / trials
+              << "% mean_us=" << elapsed / trials << std::endl;
+    return covered;
+}
+
+void printCsvHeader()
+{
+    std::cout << "strategy,sightings,unique_sightings,signatures,seed,threads,iterations,matches,"
+              << "median_us,p99_us,matches_per_sec,bytes_per_sec" << std::endl;
+}
+
+void printResult(const BenchResult &r, bool json, bool first)
+{
+    double seconds = r.medianUs / 1e6;
+    double bytes = static_cast<double>(r.uniqueSightings + r.signatures) * sizeof(int);
+    double matchesPerSec = seconds > 0 ? r.matches / seconds : 0;
+    double bytesPerSec = seconds > 0 ? bytes / seconds : 0;
+    if (json)
+    {
+        std::cout << (first ? "  " : ",\n  ") << "{\"strategy\": \"" << r.strategy << "\", \"sightings\": " << r.sightings
+                  << ", \"unique_sightings\": " << r.uniqueSightings << ", \"signatures\": " << r.signatures
+                  << ", \"seed\": " << r.seed << ", \"threads\": " << r.threads << ", \"iterations\": " << r.iterations
+                  << ", \"matches\": " << r.matches << ", \"median_us\": " << r.medianUs << ", \"p99_us\": " << r.p99Us
+                  << ", \"matches_per_sec\": " << matchesPerSec << ", \"bytes_per_sec\": " << bytesPerSec << "}";
+    }
+    else
+    {
+        std::cout << r.strategy << "," << r.sightings << "," << r.uniqueSightings << "," << r.signatures << ","
+                  << r.seed << "," << r.threads << "," << r.iterations << "," << r.matches << "," << r.medianUs << ","
+                  << r.p99Us << "," << matchesPerSec << "," << bytesPerSec << std::endl;
+    }
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]" << std::endl
+              << "Options:" << std::endl
+              << "  --sightings=LIST     sighting counts to sweep (default 1000,10000,100000)" << std::endl
+              << "  --signatures=LIST    signature counts to sweep (default 1000,10000,100000)" << std::endl
+              << "  --seeds=LIST         dataset seeds (default 0)" << std::endl
+              << "  --strategies=LIST    any of linear-scalar, linear, binary, eytzinger, packed, bitmap, radix (default all)"
+              << std::endl
+              << "  --iterations=N       timed runs per case (default 10)" << std::endl
+              << "  --warmup=N           untimed runs before those (default 2)" << std::endl
+              << "  --threads=N          1 for the serial engines (default), otherwise the threaded ones" << std::endl
+              << "  --linear-limit=N     skip linear strategies beyond N sighting x signature pairs (default 1e10)"
+              << std::endl
+              << "  --format=csv|json    output format (default csv)" << std::endl
+              << "  --approx=RATE        also validate sighting_search --approx at sample rate RATE: the exact count" << std::endl
+              << "                       must fall in the reported interval about as often as --confidence says" << std::endl
+              << "  --approx-trials=N    samples drawn per case for --approx (default 50)" << std::endl
+              << "  --confidence=LEVEL   level of the --approx interval (default 0.95)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<int> sightingCounts = {1000, 10000, 100000};
+    std::vector<int> signatureCounts = {1000, 10000, 100000};
+    std::vector<int> seeds = {0};
+    std::vector<std::string> strategies = {"linear-scalar", "linear", "binary", "eytzinger", "packed", "bitmap", "radix"};
+    int iterations = 10;
+    int warmup = 2;
+    unsigned threads = 1;
+    double linearLimit = 1e10;
+    bool json = false;
+    double approxRate = 0;
+    int approxTrials = 50;
+    double confidence = 0.95;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        std::string value = option.substr(option.find('=') + 1);
+        bool ok = option.find('=') != std::string::npos;
+        std::vector<int> numbers;
+        if (option.compare(0, 12, "--sightings=") == 0)
+        {
+            ok = ok && parseList(value, sightingCounts);
+        }
+        else if (option.compare(0, 13, "--signatures=") == 0)
+        {
+            ok = ok && parseList(value, signatureCounts);
+        }
+        else if (option.compare(0, 8, "--seeds=") == 0)
+        {
+            ok = ok && parseList(value, seeds);
+        }
+        else if (option.compare(0, 13, "--strategies=") == 0)
+        {
+            strategies.clear();
+            std::stringstream stream(value);
+            std::string item;
+            while (std::getline(stream, item, ','))
+            {
+                ok = ok && makeStrategy(item, nullptr);
+                strategies.push_back(item);
+            }
+        }
+        else if (option.compare(0, 13, "--iterations=") == 0 && parseList(value, numbers) && numbers.size() == 1)
+        {
+            iterations = numbers[0];
+            ok = iterations > 0;
+        }
+        else if (option.compare(0, 9, "--warmup=") == 0 && parseList(value, numbers) && numbers.size() == 1)
+        {
+            warmup = numbers[0];
+        }
+        else if (option.compare(0, 10, "--threads=") == 0 && parseList(value, numbers) && numbers.size() == 1)
+        {
+            threads = numbers[0];
+        }
+        else if (option.compare(0, 15, "--linear-limit=") == 0)
+        {
+            linearLimit = std::atof(value.c_str());
+        }
+        else if (option.compare(0, 9, "--approx=") == 0)
+        {
+            approxRate = std::atof(value.c_str());
+            ok = approxRate > 0 && approxRate <= 1;
+        }
+        else if (option.compare(0, 16, "--approx-trials=") == 0 && parseList(value, numbers) && numbers.size() == 1)
+        {
+            approxTrials = numbers[0];
+            ok = approxTrials > 0;
+        }
+        else if (option.compare(0, 13, "--confidence=") == 0)
+        {
+            confidence = std::atof(value.c_str());
+            ok = confidence > 0 && confidence < 1;
+        }
+        else if (option == "--format=csv" || option == "--format=json")
+        {
+            json = value == "json";
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            std::cerr << "Error: wrong option " << option << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads != 1)
+    {
+        pool.reset(new ThreadPool(threads));
+        threads = pool->Size();
+    }
+
+    bool mismatch = false;
+    bool first = true;
+    int approxCovered = 0, approxRuns = 0;
+    if (json)
+    {
+        std::cout << "[" << std::endl;
+    }
+    else
+    {
+        printCsvHeader();
+    }
+    for (auto seed : seeds)
+    {
+        for (auto nsights : sightingCounts)
+        {
+            for (auto nsigs : signatureCounts)
+            {
+                // Same data create_dataset would write for these arguments, deduplicated like the ingest does
+                std::mt19937 mt(seed);
+                std::vector<int> sightings, signatures, records;
+                IntHashSet seen(nsights);
+                generateDataset(nsights, nsigs, mt,
+                    [&](int s, int b) {
+                        int signature = sightingSignature(s, b);
+                        if (approxRate > 0)
+                            records.push_back(signature);
+                        if (seen.Insert(signature))
+                            sightings.push_back(signature);
+                    },
+                    [&](int s) { signatures.push_back(s); });
+
+                int expected = -1;
+                for (auto &name : strategies)
+                {
+                    bool linear = name.compare(0, 6, "linear") == 0;
+                    if (linear && static_cast<double>(sightings.size()) * signatures.size() > linearLimit)
+                    {
+                        continue;
+                    }
+                    BenchResult result = {name, nsights, sightings.size(), nsigs, seed, threads, iterations, 0, 0, 0};
+                    runStrategy(makeStrategy(name, pool.get()), sightings, signatures, warmup, iterations, result);
+                    printResult(result, json, first);
+                    first = false;
+                    if (expected >= 0 && result.matches != expected)
+                    {
+                        std::cerr << "Error: " << name << " found " << result.matches << " matches, expected "
+                                  << expected << " (sightings " << nsights << ", signatures " << nsigs << ", seed "
+                                  << seed << ")" << std::endl;
+                        mismatch = true;
+                    }
+                    if (expected < 0)
+                    {
+                        expected = result.matches;
+                    }
+                }
+                if (approxRate > 0)
+                {
+                    if (expected < 0)
+                    {
+                        std::sort(sightings.begin(), sightings.end());
+                        expected = binSearch(sightings, signatures);
+                    }
+                    approxCovered += checkApprox(records, signatures, expected, approxRate, confidence, approxTrials, seed);
+                    approxRuns += approxTrials;
+                }
+            }
+        }
+    }
+    if (json)
+    {
+        std::cout << std::endl << "]" << std::endl;
+    }
+    // Intervals may miss 1 - confidence of the time; three standard deviations below that is a failure
+    double floor = confidence - 3 * std::sqrt(confidence * (1 - confidence) / std::max(approxRuns, 1));
+    if (approxRuns > 0 && approxCovered < floor * approxRuns)
+    {
+        std::cerr << "Error: --approx intervals held the exact count " << approxCovered << " times out of "
+                  << approxRuns << ", expected at least " << floor * approxRuns << std::endl;
+        mismatch = true;
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#ifndef BITMAP_SEARCH_H_
+#define BITMAP_SEARCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per value in [min, max] of a set of ints.
+// Sighting signatures are ceil(speed * brightness / 10) with brightness clamped
+// to +-30, so their range stays small and a lookup is a single bit test,
+// without sorting anything first.
+class SignatureBitmap
+{
+public:
+    // Build from @values, in any order
+    // Complexity: O(N + (max - min) / 64)
+    explicit SignatureBitmap(const std::vector<int> &values) : low(0), span(0)
+    {
+        if (values.empty())
+            return;
+        auto range = std::minmax_element(values.begin(), values.end());
+        low = *range.first;
+        span = static_cast<uint64_t>(static_cast<int64_t>(*range.second) - low) + 1;
+        words.assign((span + 63) / 64, 0);
+        for (auto v : values)
+        {
+            uint64_t bit = Offset(v);
+            words[bit >> 6] |= uint64_t(1) << (bit & 63);
+        }
+    }
+
+    // Return whether @key is in the set
+    // Complexity: O(1)
+    bool Contains(int key) const
+    {
+        uint64_t bit = Offset(key);
+        if (bit >= span)
+            return false;
+        return (words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    // Return whether a bitmap over @values is worth it: no bigger than the
+    // values themselves, or small enough to sit in L2 anyway
+    // Complexity: O(N)
+    static bool Suits(const std::vector<int> &values)
+    {
+        if (values.empty())
+            return false;
+        auto range = std::minmax_element(values.begin(), values.end());
+        uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(*range.second) - *range.first) + 1;
+        return bits <= kMaxBitsPerValue * values.size() || bits <= kAlwaysSmallBits;
+    }
+
+private:
+    static const uint64_t kMaxBitsPerValue = 32;
+    static const uint64_t kAlwaysSmallBits = uint64_t(1) << 20;
+
+    int low;
+    uint64_t span;
+    std::vector<uint64_t> words;
+
+    // Distance from the low end; values below it wrap around to huge offsets
+    uint64_t Offset(int value) const
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(value) - low);
+    }
+};
+
+#endif // BITMAP_SEARCH_H_
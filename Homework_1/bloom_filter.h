@@ -0,0 +1,182 @@
+#ifndef BLOOM_FILTER_H_
+#define BLOOM_FILTER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <vector>
+
+// Blocked Bloom filter over a set of ints, used to turn away probes that
+// cannot match before they reach the exact index. Every key hashes to one
+// 64 byte block and sets all its bits inside it, so a lookup (hit or miss)
+// reads a single cache line. Blocks do not fill evenly, which costs accuracy
+// that grows as the target rate shrinks; the size is therefore picked from the
+// expected rate of the blocked layout rather than the textbook formula.
+class BloomFilter
+{
+public:
+    // Build from @values (any order, duplicates fine) for a false positive rate of about @fpRate
+    // Complexity: O(N)
+    BloomFilter(const std::vector<int> &values, double fpRate) : blocks(1), hashes(1), words(nullptr)
+    {
+        fpRate = std::min(std::max(fpRate, 1e-6), 0.5);
+        double bitsPerKey = 2;
+        while (bitsPerKey < 64 && ExpectedRate(bitsPerKey, Hashes(bitsPerKey)) > fpRate)
+            bitsPerKey += 0.25;
+        hashes = Hashes(bitsPerKey);
+        size_t bits = static_cast<size_t>(std::ceil(bitsPerKey * std::max<size_t>(values.size(), 1)));
+        blocks = std::max<size_t>((bits + kBlockBits - 1) / kBlockBits, 1);
+        void *memory = nullptr;
+        if (posix_memalign(&memory, kBlockBytes, blocks * kBlockBytes) != 0)
+            throw std::bad_alloc();
+        words = static_cast<uint64_t *>(memory);
+        std::memset(words, 0, blocks * kBlockBytes);
+        for (auto v : values)
+            Insert(v);
+    }
+    ~BloomFilter()
+    {
+        free(words);
+    }
+    BloomFilter(const BloomFilter &) = delete;
+    BloomFilter &operator=(const BloomFilter &) = delete;
+
+    // Return false if @key is certainly not in the set, true if it might be
+    // Complexity: O(hashes), one cache line
+    bool MayContain(int key) const
+    {
+        uint64_t h = Hash(key);
+        const uint64_t *block = words + Block(h) * kBlockWords;
+        uint64_t bits = h;
+        for (unsigned i = 0; i < hashes; i++)
+        {
+            unsigned bit = Bit(bits, i);
+            if (!(block[bit >> 6] & (uint64_t(1) << (bit & 63))))
+                return false;
+        }
+        return true;
+    }
+
+    // Return size of the filter in bits
+    size_t Bits() const noexcept
+    {
+        return blocks * kBlockBits;
+    }
+
+    // Return number of bits set (and tested) per key
+    unsigned Hashes() const noexcept
+    {
+        return hashes;
+    }
+
+    // Return false positive rate of a blocked filter with @bitsPerKey bits and @k hashes per key:
+    // the keys landing in a block follow a Poisson law, each load giving the plain Bloom rate
+    static double ExpectedRate(double bitsPerKey, unsigned k)
+    {
+        double lambda = kBlockBits / bitsPerKey;
+        double p = std::exp(-lambda);
+        double rate = 0;
+        for (unsigned keys = 0; keys < lambda + 12 * std::sqrt(lambda) + 12; keys++)
+        {
+            rate += p * std::pow(1 - std::pow(1 - 1.0 / kBlockBits, static_cast<double>(k) * keys), k);
+            p *= lambda / (keys + 1);
+        }
+        return rate;
+    }
+
+private:
+    enum : size_t
+    {
+        kBlockBytes = 64,
+        kBlockBits = kBlockBytes * 8,
+        kBlockWords = kBlockBytes / sizeof(uint64_t)
+    };
+
+    size_t blocks;
+    unsigned hashes;
+    uint64_t *words;
+
+    // Best number of hashes for @bitsPerKey, capped to keep lookups short
+    static unsigned Hashes(double bitsPerKey)
+    {
+        return static_cast<unsigned>(std::min(std::max(std::lround(bitsPerKey * std::log(2.0)), 1L), 16L));
+    }
+
+    void Insert(int key)
+    {
+        uint64_t h = Hash(key);
+        uint64_t *block = words + Block(h) * kBlockWords;
+        uint64_t bits = h;
+        for (unsigned i = 0; i < hashes; i++)
+        {
+            unsigned bit = Bit(bits, i);
+            block[bit >> 6] |= uint64_t(1) << (bit & 63);
+        }
+    }
+
+    static uint64_t Hash(int key)
+    {
+        return Mix(static_cast<uint32_t>(key));
+    }
+
+    // Finalizer of MurmurHash3, every input bit affects every output bit
+    static uint64_t Mix(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Bit of probe @i inside the block: 9 bit slices of the low half of the hash (the block comes
+    // from the high half), remixed every 3 probes so that the positions stay independent
+    static unsigned Bit(uint64_t &bits, unsigned i)
+    {
+        unsigned slot = i % 3;
+        if (i > 0 && slot == 0)
+            bits = Mix(bits);
+        return static_cast<unsigned>(bits >> (9 * slot)) & (kBlockBits - 1);
+    }
+
+    // High hash bits scaled onto [0, blocks) without a division
+    size_t Block(uint64_t h) const
+    {
+        return static_cast<size_t>(((h >> 32) * blocks) >> 32);
+    }
+};
+
+// What the prefilter did during one search
+struct PrefilterStats
+{
+    long long probes = 0;     // lookups made
+    long long passed = 0;     // lookups the filter let through to the exact search
+    long long matches = 0;    // of those, the ones the exact search found
+    size_t bits = 0;
+    unsigned hashes = 0;
+};
+
+/*
+Name        : printPrefilterStats
+Description : One line summary of @stats: probes turned away, let through, and the false positive rate seen
+              (false positives over all the lookups of keys that are not in the set)
+Receives    : output stream, the statistics
+Returns     : nothing.
+*/
+inline void printPrefilterStats(std::ostream &out, const PrefilterStats &stats)
+{
+    long long negatives = stats.probes - stats.matches;
+    long long falsePositives = stats.passed - stats.matches;
+    out << "prefilter: bits=" << stats.bits << " hashes=" << stats.hashes << " probes=" << stats.probes
+        << " rejected=" << stats.probes - stats.passed << " passed=" << stats.passed
+        << " false_positives=" << falsePositives
+        << " fp_rate=" << (negatives > 0 ? static_cast<double>(falsePositives) / negatives : 0.0) << std::endl;
+}
+
+#endif // BLOOM_FILTER_H_
@@ -0,0 +1,52 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dataset_format.h"
+
+/*
+ * Converts a text dataset written by create_dataset into the binary columnar
+ * format (see dataset_format.h), so sighting_search can load it without
+ * parsing.
+ */
+int main(int argc, char *argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0]
+        << " <sighting_file.dat> <signature_file.dat> <suffix>"
+        << std::endl;
+    exit(1);
+  }
+
+  std::ifstream sights(argv[1]);
+  if (!sights.is_open()) {
+    std::cerr << "Error: cannot open file " << argv[1] << std::endl;
+    exit(1);
+  }
+  std::ifstream sigs(argv[2]);
+  if (!sigs.is_open()) {
+    std::cerr << "Error: cannot open file " << argv[2] << std::endl;
+    exit(1);
+  }
+
+  std::vector<int> speeds, brights, sight_sigs, known_sigs;
+  int s, b;
+  while (sights >> s >> b) {
+    speeds.push_back(s);
+    brights.push_back(b);
+    sight_sigs.push_back(sightingSignature(s, b));
+  }
+  while (sigs >> s)
+    known_sigs.push_back(s);
+
+  std::string sights_name = std::string("sightings_") + argv[3] + ".bin";
+  std::string sigs_name = std::string("signatures_") + argv[3] + ".bin";
+  if (!writeDataset(sights_name, kSightingsDataset,
+                    {&speeds, &brights, &sight_sigs}) ||
+      !writeDataset(sigs_name, kSignaturesDataset, {&known_sigs})) {
+    std::cerr << "Error: cannot open output file(s)" << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
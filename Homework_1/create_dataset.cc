@@ -1,39 +1,266 @@
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "dataset_format.h"
+#include "dataset_generator.h"
+
+/* Appends @value in decimal to @out, without going through a stream */
+static void appendInt(std::string &out, int value) {
+  char digits[12];
+  int n = 0;
+  unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>(value)
+                                 : static_cast<unsigned>(value);
+  do {
+    digits[n++] = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude);
+  if (value < 0)
+    out += '-';
+  while (n)
+    out += digits[--n];
+}
+
+/*
+ * Runs @fn(block, begin, end) for every kGeneratorBlock sized block of
+ * [0, @count) on @threads threads. Blocks are claimed in increasing order.
+ */
+template <typename BlockFn>
+static void forEachBlock(long long count, unsigned threads, BlockFn fn) {
+  long long blocks = (count + kGeneratorBlock - 1) / kGeneratorBlock;
+  std::atomic<long long> next(0);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      for (long long b = next++; b < blocks; b = next++) {
+        long long begin = b * kGeneratorBlock;
+        fn(b, begin, std::min(count, begin + kGeneratorBlock));
+      }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+}
+
+/*
+ * Text output of the parallel generator: blocks are formatted concurrently
+ * but appended to the file strictly in block order. Since blocks are claimed
+ * in order, the lowest pending block always belongs to a running thread, and
+ * at most one formatted block per thread waits in memory.
+ */
+class OrderedWriter {
+ public:
+  explicit OrderedWriter(std::ofstream &out) : out_(out), next_(0) {}
+
+  void Write(long long block, const std::string &text) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    turn_.wait(lock, [&] { return next_ == block; });
+    out_.write(text.data(), text.size());
+    next_++;
+    turn_.notify_all();
+  }
+
+ private:
+  std::ofstream &out_;
+  long long next_;
+  std::mutex mutex_;
+  std::condition_variable turn_;
+};
+
+/* Writes the text file of one stream (sightings or signatures) */
+template <typename FormatFn>
+static bool writeTextParallel(const std::string &name, long long count,
+                              unsigned threads, FormatFn format) {
+  std::ofstream out(name, std::ofstream::trunc | std::ofstream::binary);
+  if (!out.good())
+    return false;
+  OrderedWriter writer(out);
+  forEachBlock(count, threads, [&](long long block, long long begin,
+                                   long long end) {
+    std::string text;
+    text.reserve((end - begin) * 8);
+    format(block, end - begin, text);
+    writer.Write(block, text);
+  });
+  return out.good();
+}
+
+/*
+ * Binary output of the parallel generator: every block knows where its
+ * slice of each column lives, so it pwrite()s straight there; the header
+ * goes last, once the per-block min/max have been merged.
+ */
+template <typename DrawFn>
+static bool writeBinaryParallel(const std::string &name, DatasetKind kind,
+                                uint32_t ncols, long long count,
+                                unsigned threads, DrawFn draw) {
+  int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  DatasetHeader header = makeDatasetHeader(kind, ncols, count);
+  for (uint32_t c = 0; c < ncols; c++) {
+    header.min[c] = INT_MAX;
+    header.max[c] = INT_MIN;
+  }
+  off_t column_bytes = static_cast<off_t>(count) * sizeof(int32_t);
+  bool ok = ::ftruncate(fd, sizeof(header) + ncols * column_bytes) == 0;
+  std::mutex stats;
+  forEachBlock(count, threads, [&](long long block, long long begin,
+                                   long long end) {
+    std::vector<std::vector<int>> cols(ncols);
+    draw(block, end - begin, cols);
+    for (uint32_t c = 0; c < ncols; c++) {
+      auto range = std::minmax_element(cols[c].begin(), cols[c].end());
+      size_t bytes = cols[c].size() * sizeof(int32_t);
+      off_t at = sizeof(header) + c * column_bytes + begin * sizeof(int32_t);
+      bool written = ::pwrite(fd, cols[c].data(), bytes, at) ==
+                     static_cast<ssize_t>(bytes);
+      std::lock_guard<std::mutex> lock(stats);
+      ok = ok && written;
+      header.min[c] = std::min(header.min[c], *range.first);
+      header.max[c] = std::max(header.max[c], *range.second);
+    }
+  });
+  ok = ok && ::pwrite(fd, &header, sizeof(header), 0) ==
+                 static_cast<ssize_t>(sizeof(header));
+  return ::close(fd) == 0 && ok;
+}
+
+/*
+ * Parallel generator (--threads=N). Each block of kGeneratorBlock records
+ * draws from its own generator derived from (seed, block), see
+ * blockGenerator(), so a given seed gives the same files whatever the
+ * number of threads. They differ from the serial generator's files, which
+ * draw everything from one stream.
+ */
+static bool generateParallel(int nsights, int nsigs, unsigned seed,
+                             unsigned threads, bool binary,
+                             const std::string &sights_name,
+                             const std::string &sigs_name) {
+  if (binary) {
+    return writeBinaryParallel(
+               sights_name, kSightingsDataset, 3, nsights, threads,
+               [&](long long block, long long n,
+                   std::vector<std::vector<int>> &cols) {
+                 std::mt19937 mt = blockGenerator(seed, 0, block);
+                 generateSightings(nsights, n, mt, [&](int s, int b) {
+                   cols[kSpeedColumn].push_back(s);
+                   cols[kBrightnessColumn].push_back(b);
+                   cols[kSignatureColumn].push_back(sightingSignature(s, b));
+                 });
+               }) &&
+           writeBinaryParallel(
+               sigs_name, kSignaturesDataset, 1, nsigs, threads,
+               [&](long long block, long long n,
+                   std::vector<std::vector<int>> &cols) {
+                 std::mt19937 mt = blockGenerator(seed, 1, block);
+                 generateSignatures(n, mt, [&](int s) {
+                   cols[0].push_back(s);
+                 });
+               });
+  }
+  return writeTextParallel(
+             sights_name, nsights, threads,
+             [&](long long block, long long n, std::string &text) {
+               std::mt19937 mt = blockGenerator(seed, 0, block);
+               generateSightings(nsights, n, mt, [&](int s, int b) {
+                 appendInt(text, s);
+                 text += ' ';
+                 appendInt(text, b);
+                 text += '\n';
+               });
+             }) &&
+         writeTextParallel(
+             sigs_name, nsigs, threads,
+             [&](long long block, long long n, std::string &text) {
+               std::mt19937 mt = blockGenerator(seed, 1, block);
+               generateSignatures(n, mt, [&](int s) {
+                 appendInt(text, s);
+                 text += '\n';
+               });
+             });
+}
+
+/*
+ * Parses the N of --threads=N into @threads: a plain decimal count, 0 for one
+ * per hardware thread, at most 4 per hardware thread. False for anything else.
+ */
+static bool parseThreads(const std::string &text, int &threads) {
+  if (text.empty() || text.size() > 9 ||
+      text.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  int value = std::stoi(text);
+  if (value > 4 * static_cast<int>(
+                      std::max(1u, std::thread::hardware_concurrency())))
+    return false;
+  threads = value;
+  return true;
+}
+
+static void usage(const char *program) {
+  std::cerr << "Usage: " << program
+      << " <num_sights> <num_signatures> <suffix> [seed] [--binary]"
+      << " [--threads=N]"
+      << std::endl;
+  exit(1);
+}
 
 int main(int argc, char *argv[]) {
-  if (argc < 4) {
-    std::cerr << "Usage: " << argv[0]
-        << " <num_sights> <num_signatures> <suffix> [seed]"
-        << std::endl;
-    exit(1);
+  /* --binary and --threads=N can appear anywhere, the rest are positional */
+  bool binary = false;
+  int threads = -1;
+  std::vector<char *> args;
+  for (int i = 0; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--binary")
+      binary = true;
+    else if (arg.compare(0, 10, "--threads=") == 0) {
+      if (!parseThreads(arg.substr(10), threads))
+        usage(argv[0]);
+    } else
+      args.push_back(argv[i]);
   }
 
-  int nsights = std::stoi(argv[1]);
-  int nsigs = std::stoi(argv[2]);
+  if (args.size() < 4)
+    usage(argv[0]);
+
+  int nsights = std::stoi(args[1]);
+  int nsigs = std::stoi(args[2]);
   if (nsights <= 0 || nsigs <= 0) {
     std::cerr << "Error: wrong arguments" << std::endl;
     exit(1);
   }
 
+  std::string ext = binary ? ".bin" : ".dat";
+  std::string sights_name = std::string("sightings_") + args[3] + ext;
+  std::string sigs_name = std::string("signatures_") + args[3] + ext;
   std::ofstream sights, sigs;
-  sights.open(std::string("sightings_") + argv[3] + ".dat",
-             std::ofstream::trunc);
-  sigs.open(std::string("signatures_") + argv[3] + ".dat",
-            std::ofstream::trunc);
-  if (!sights.good() || !sigs.good()) {
-    std::cerr << "Error: cannot open output file(s)" << std::endl;
-    exit(1);
+  if (!binary && threads < 0) {
+    sights.open(sights_name, std::ofstream::trunc);
+    sigs.open(sigs_name, std::ofstream::trunc);
+    if (!sights.good() || !sigs.good()) {
+      std::cerr << "Error: cannot open output file(s)" << std::endl;
+      exit(1);
+    }
   }
 
   /* random generator */
   std::random_device rd;
   std::mt19937 mt(rd());
 
-  if (argc == 5) {
-    int seed = std::stoi(argv[4]);
+  if (args.size() == 5) {
+    int seed = std::stoi(args[4]);
     if (seed < 0) {
       std::cerr << "Error: wrong seed" << std::endl;
       exit(1);
@@ -41,20 +268,51 @@ int main(int argc, char *argv[]) {
     mt.seed(seed);
   }
 
-  /* random number distribution for sights */
-  std::normal_distribution<float> speed_dist(25, 20);
-  std::normal_distribution<float> bright_dist(0, 20);
-  for (int i = 0; i < nsights; i++) {
-    int s = std::min(nsights, std::max(1, static_cast<int>(speed_dist(mt))));
-    int b = std::min(30, std::max(-30, static_cast<int>(bright_dist(mt))));
-    sights << s << " " << b << "\n";
+  if (threads >= 0) {
+    unsigned base_seed = args.size() == 5 ? std::stoi(args[4]) : rd();
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!generateParallel(nsights, nsigs, base_seed, threads, binary,
+                          sights_name, sigs_name)) {
+      std::cerr << "Error: cannot open output file(s)" << std::endl;
+      exit(1);
+    }
+    return 0;
   }
 
-  /* random number distribution for signatures */
-  std::normal_distribution<float> sig_dist(0, 25 * 20 / 10.0);
-  for (int i = 0; i < nsigs; i++) {
-    int s = static_cast<int>(sig_dist(mt));
-    sigs << s << "\n";
+  /* binary datasets are written column by column, so keep them around */
+  std::vector<int> speeds, brights, sight_sigs, known_sigs;
+  if (binary) {
+    speeds.reserve(nsights);
+    brights.reserve(nsights);
+    sight_sigs.reserve(nsights);
+    known_sigs.reserve(nsigs);
+  }
+
+  generateDataset(nsights, nsigs, mt,
+      [&](int s, int b) {
+        if (binary) {
+          speeds.push_back(s);
+          brights.push_back(b);
+          sight_sigs.push_back(sightingSignature(s, b));
+        } else {
+          sights << s << " " << b << "\n";
+        }
+      },
+      [&](int s) {
+        if (binary)
+          known_sigs.push_back(s);
+        else
+          sigs << s << "\n";
+      });
+
+  if (binary) {
+    if (!writeDataset(sights_name, kSightingsDataset,
+                      {&speeds, &brights, &sight_sigs}) ||
+        !writeDataset(sigs_name, kSignaturesDataset, {&known_sigs})) {
+      std::cerr << "Error: cannot open output file(s)" << std::endl;
+      exit(1);
+    }
   }
 
   sights.close();
@@ -0,0 +1,263 @@
+#ifndef DAT_READER_H_
+#define DAT_READER_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Whole contents of a .dat file in memory, without copying when possible.
+// Regular files are mmap'd read-only; pipes and FIFOs are drained with read()
+// into a growing buffer since they cannot be mapped.
+class DatFile
+{
+public:
+    DatFile() : data(nullptr), length(0), mapped(false) {}
+    ~DatFile()
+    {
+        Close();
+    }
+    DatFile(const DatFile &) = delete;
+    DatFile &operator=(const DatFile &) = delete;
+
+    // Map or read @filename, return false if it cannot be opened
+    bool Open(const std::string &filename)
+    {
+        Close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        bool ok = ::fstat(fd, &info) == 0;
+        if (ok && S_ISREG(info.st_mode))
+            ok = Map(fd, static_cast<size_t>(info.st_size));
+        else if (ok)
+            ok = ReadAll(fd);
+        ::close(fd);
+        return ok;
+    }
+
+    void Close()
+    {
+        if (mapped)
+            ::munmap(const_cast<char *>(data), length);
+        buffer.clear();
+        data = nullptr;
+        length = 0;
+        mapped = false;
+    }
+
+    const char *Begin() const { return data; }
+    const char *End() const { return data + length; }
+    size_t Length() const { return length; }
+
+private:
+    const char *data;
+    size_t length;
+    bool mapped;
+    std::vector<char> buffer;
+
+    bool Map(int fd, size_t bytes)
+    {
+        if (bytes == 0)
+            return true;
+        void *addr = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            return ReadAll(fd);
+        ::madvise(addr, bytes, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(addr);
+        length = bytes;
+        mapped = true;
+        return true;
+    }
+
+    bool ReadAll(int fd)
+    {
+        const size_t chunk = 1 << 20;
+        size_t used = 0;
+        while (true)
+        {
+            buffer.resize(used + chunk);
+            ssize_t got = ::read(fd, buffer.data() + used, chunk);
+            if (got < 0)
+                return false;
+            if (got == 0)
+                break;
+            used += static_cast<size_t>(got);
+        }
+        buffer.resize(used);
+        data = buffer.data();
+        length = used;
+        return true;
+    }
+};
+
+// Reads whitespace separated signed decimal ints out of a byte range.
+// Stops at the first token that is not an int (or does not fit in one),
+// the same way `stream >> int` does.
+class IntScanner
+{
+public:
+    IntScanner(const char *begin, const char *end) : pos(begin), end(end) {}
+
+    // Store the next int in @value, return false at end of input or bad token
+    bool Next(int &value)
+    {
+        while (pos != end && IsSpace(*pos))
+            pos++;
+        if (pos == end)
+            return false;
+        bool negative = false;
+        if (*pos == '-' || *pos == '+')
+        {
+            negative = *pos == '-';
+            pos++;
+        }
+        if (pos == end || !IsDigit(*pos))
+            return Fail();
+        long long magnitude = 0;
+        const long long limit = negative ? 2147483648LL : 2147483647LL;
+        while (pos != end && IsDigit(*pos))
+        {
+            magnitude = magnitude * 10 + (*pos - '0');
+            if (magnitude > limit)
+                return Fail();
+            pos++;
+        }
+        value = static_cast<int>(negative ? -magnitude : magnitude);
+        return true;
+    }
+
+    // Return where the next read starts: right after the last int read, or the end once the scan stopped
+    const char *Pos() const
+    {
+        return pos;
+    }
+
+private:
+    const char *pos;
+    const char *end;
+
+    static bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+    static bool IsDigit(char c)
+    {
+        return static_cast<unsigned>(c - '0') < 10;
+    }
+    bool Fail()
+    {
+        pos = end;
+        return false;
+    }
+};
+
+// Incremental version of IntScanner for input that keeps arriving (stdin, FIFOs).
+// Next() only hands out tokens known to be complete; a token touching the end
+// of the buffer might continue in the next read, so it waits for Fill() or EOF.
+class IntStream
+{
+public:
+    explicit IntStream(int fd) : fd(fd), begin(0), end(0), eof(false), failed(false), buffer(1 << 16) {}
+
+    // Store the next complete int in @value, false if none is available yet
+    bool Next(int &value)
+    {
+        while (begin != end && IsSpace(buffer[begin]))
+            begin++;
+        size_t stop = begin;
+        while (stop != end && !IsSpace(buffer[stop]))
+            stop++;
+        if (failed || stop == begin || (stop == end && !eof))
+            return false;
+        IntScanner scanner(buffer.data() + begin, buffer.data() + stop);
+        if (!scanner.Next(value))
+        {
+            failed = true;
+            return false;
+        }
+        // An int followed by more of the token ("-11abc") is read, and the input ends there, as with IntScanner
+        failed = scanner.Pos() != buffer.data() + stop;
+        begin = stop;
+        return true;
+    }
+
+    // Wait up to @timeout_ms (-1 forever) for more input and append it to the buffer.
+    // Returns false if nothing arrived in time.
+    bool Fill(int timeout_ms)
+    {
+        if (eof || failed)
+            return false;
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (timeout_ms >= 0)
+        {
+            int ready = ::poll(&pfd, 1, timeout_ms);
+            if (ready < 0 && errno != EINTR)
+                failed = true;
+            if (ready <= 0)
+                return false;
+        }
+        // Keep the unread tail, grow only when a single token fills the buffer
+        if (begin > 0)
+        {
+            std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (got < 0 && errno == EINTR)
+            return false;
+        // A read error (EIO, EBADF) is not the end of the input
+        if (got < 0)
+            failed = true;
+        else if (got == 0)
+            eof = true;
+        else
+            end += static_cast<size_t>(got);
+        return got > 0;
+    }
+
+    // True once a token that is not an int was met or a read failed
+    bool Failed() const
+    {
+        return failed;
+    }
+
+    // True once the input is exhausted (EOF, a bad token or a read error) and fully consumed
+    bool Done() const
+    {
+        if (failed)
+            return true;
+        if (!eof)
+            return false;
+        for (size_t i = begin; i != end; i++)
+            if (!IsSpace(buffer[i]))
+                return false;
+        return true;
+    }
+
+private:
+    int fd;
+    size_t begin;
+    size_t end;
+    bool eof;
+    bool failed;
+    std::vector<char> buffer;
+
+    static bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+};
+
+#endif // DAT_READER_H_
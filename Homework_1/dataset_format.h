@@ -0,0 +1,177 @@
+#ifndef DATASET_FORMAT_H_
+#define DATASET_FORMAT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "dat_reader.h"
+
+//
+// Binary columnar dataset format (version 1)
+//
+// A 64 byte header followed by `columns` packed int32 columns of `count`
+// values each, in host (little-endian) byte order:
+//   sightings file  : speed, brightness, signature
+//   signatures file : signature
+//   histogram file  : signature, sighting multiplicity, hit flag (sighting_search --histogram)
+// The signature column of a sightings file is precomputed with
+// sightingSignature(), so loading it needs no parsing and no arithmetic.
+//
+
+const char kDatasetMagic[4] = {'S', 'G', 'D', 'S'};
+const uint32_t kDatasetVersion = 1;
+const size_t kDatasetMaxColumns = 4;
+
+enum DatasetKind : uint32_t
+{
+    kSightingsDataset = 1,
+    kSignaturesDataset = 2,
+    kHistogramDataset = 3
+};
+
+// Column positions inside a sightings file
+enum SightingColumn
+{
+    kSpeedColumn = 0,
+    kBrightnessColumn = 1,
+    kSignatureColumn = 2
+};
+
+// Column positions inside a histogram file
+enum HistogramColumn
+{
+    kHistogramSignatureColumn = 0,
+    kHistogramMultiplicityColumn = 1,
+    kHistogramHitColumn = 2
+};
+
+struct DatasetHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t columns;
+    uint64_t count;
+    int32_t min[kDatasetMaxColumns];
+    int32_t max[kDatasetMaxColumns];
+    uint8_t reserved[8];
+};
+static_assert(sizeof(DatasetHeader) == 64, "DatasetHeader must stay 64 bytes");
+
+/*
+Name        : sightingSignature
+Description : Signature of one sighting, ceil(speed * brightness / 10), in integer arithmetic.
+              C++ division truncates toward zero, which is already the ceiling for a negative product;
+              a positive one goes up by one when the division leaves a remainder. Same result as
+              std::ceil(double(speed) * double(brightness) / 10) for every signature that fits in an int.
+Receives    : speed and brightness of the sighting
+Returns     : the signature
+*/
+inline int sightingSignature(int speed, int brightness)
+{
+    int64_t product = static_cast<int64_t>(speed) * brightness;
+    int64_t quotient = product / 10;
+    return static_cast<int>(quotient + (product - quotient * 10 > 0));
+}
+
+/*
+Name        : makeDatasetHeader
+Description : Header for a dataset of @columns columns of @count rows, stats left at zero for the caller
+Receives    : kind of dataset, number of columns, number of rows
+Returns     : the header.
+*/
+inline DatasetHeader makeDatasetHeader(DatasetKind kind, uint32_t columns, uint64_t count)
+{
+    DatasetHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kDatasetMagic, sizeof(header.magic));
+    header.version = kDatasetVersion;
+    header.kind = kind;
+    header.columns = columns;
+    header.count = count;
+    return header;
+}
+
+/*
+Name        : writeDataset
+Description : Writes @columns (all of the same length) as a binary dataset file, header stats included.
+Receives    : Filename, kind of dataset, the columns in file order
+Returns     : true on success, false if the file cannot be written.
+*/
+inline bool writeDataset(const std::string &filename, DatasetKind kind, const std::vector<const std::vector<int> *> &columns)
+{
+    if (columns.empty() || columns.size() > kDatasetMaxColumns)
+        return false;
+    DatasetHeader header = makeDatasetHeader(kind, static_cast<uint32_t>(columns.size()), columns[0]->size());
+    for (size_t c = 0; c < columns.size(); c++)
+    {
+        const std::vector<int> &column = *columns[c];
+        if (column.size() != header.count)
+            return false;
+        if (!column.empty())
+        {
+            auto range = std::minmax_element(column.begin(), column.end());
+            header.min[c] = *range.first;
+            header.max[c] = *range.second;
+        }
+    }
+
+    std::ofstream out(filename, std::ofstream::binary | std::ofstream::trunc);
+    if (!out.good())
+        return false;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto column : columns)
+        out.write(reinterpret_cast<const char *>(column->data()), column->size() * sizeof(int32_t));
+    return out.good();
+}
+
+/*
+Name        : validDatasetHeader
+Description : Checks @header for the magic, a supported version, and columns that fit in a file of @fileBytes
+Receives    : the header, size of the whole file in bytes
+Returns     : true if the file is a (valid) binary dataset.
+*/
+inline bool validDatasetHeader(const DatasetHeader &header, uint64_t fileBytes)
+{
+    if (fileBytes < sizeof(DatasetHeader))
+        return false;
+    if (std::memcmp(header.magic, kDatasetMagic, sizeof(header.magic)) != 0 ||
+        header.version != kDatasetVersion || header.columns == 0 || header.columns > kDatasetMaxColumns)
+        return false;
+    if (header.count > fileBytes / sizeof(int32_t))
+        return false;
+    uint64_t payload = header.count * header.columns * sizeof(int32_t);
+    return fileBytes - sizeof(DatasetHeader) >= payload;
+}
+
+/*
+Name        : datasetHeader
+Description : Checks whether a loaded file is a binary dataset with a supported version and complete columns.
+Receives    : the loaded file
+Returns     : pointer to the header inside the file, nullptr if it is not a (valid) binary dataset.
+*/
+inline const DatasetHeader *datasetHeader(const DatFile &file)
+{
+    if (file.Length() < sizeof(DatasetHeader))
+        return nullptr;
+    const DatasetHeader *header = reinterpret_cast<const DatasetHeader *>(file.Begin());
+    return validDatasetHeader(*header, file.Length()) ? header : nullptr;
+}
+
+/*
+Name        : datasetColumn
+Description : Locates column @index of a binary dataset already validated by datasetHeader
+Receives    : the loaded file, column index
+Returns     : pointer to the first value of the column (header->count values follow).
+*/
+inline const int32_t *datasetColumn(const DatFile &file, size_t index)
+{
+    const DatasetHeader *header = reinterpret_cast<const DatasetHeader *>(file.Begin());
+    return reinterpret_cast<const int32_t *>(file.Begin() + sizeof(DatasetHeader)) + index * header->count;
+}
+
+#endif // DATASET_FORMAT_H_
@@ -0,0 +1,68 @@
+#ifndef DATASET_GENERATOR_H_
+#define DATASET_GENERATOR_H_
+
+#include <algorithm>
+#include <random>
+
+/* Records per block of the parallel generator */
+const long long kGeneratorBlock = 1 << 16;
+
+/*
+ * Draws @count sightings, speeds clamped to [1, @max_speed], and hands each
+ * one to @on_sighting(speed, brightness).
+ */
+template <typename SightingFn>
+void generateSightings(int max_speed, long long count, std::mt19937 &mt,
+                       SightingFn on_sighting) {
+  /* random number distribution for sights */
+  std::normal_distribution<float> speed_dist(25, 20);
+  std::normal_distribution<float> bright_dist(0, 20);
+  for (long long i = 0; i < count; i++) {
+    int s = std::min(max_speed, std::max(1, static_cast<int>(speed_dist(mt))));
+    int b = std::min(30, std::max(-30, static_cast<int>(bright_dist(mt))));
+    on_sighting(s, b);
+  }
+}
+
+/*
+ * Draws @count signatures and hands each one to @on_signature(signature).
+ */
+template <typename SignatureFn>
+void generateSignatures(long long count, std::mt19937 &mt,
+                        SignatureFn on_signature) {
+  /* random number distribution for signatures */
+  std::normal_distribution<float> sig_dist(0, 25 * 20 / 10.0);
+  for (long long i = 0; i < count; i++) {
+    int s = static_cast<int>(sig_dist(mt));
+    on_signature(s);
+  }
+}
+
+/*
+ * Random sightings and signatures, drawn the way create_dataset always has:
+ * all sightings first, then all signatures, from the same generator.
+ * @on_sighting(speed, brightness) and @on_signature(signature) receive the
+ * values in order, so callers can stream them to a file or keep them in
+ * memory (the benchmark does the latter).
+ */
+template <typename SightingFn, typename SignatureFn>
+void generateDataset(int nsights, int nsigs, std::mt19937 &mt,
+                     SightingFn on_sighting, SignatureFn on_signature) {
+  generateSightings(nsights, nsights, mt, on_sighting);
+  generateSignatures(nsigs, mt, on_signature);
+}
+
+/*
+ * Generator for block @block of @stream (0 for sightings, 1 for signatures)
+ * of the parallel generator. It only depends on the seed and the block
+ * number, so blocks can be drawn in any order, by any number of threads,
+ * and still give the same dataset.
+ */
+inline std::mt19937 blockGenerator(unsigned seed, unsigned stream,
+                                   long long block) {
+  std::seed_seq seq{seed, stream, static_cast<unsigned>(block),
+                    static_cast<unsigned>(block >> 32)};
+  return std::mt19937(seq);
+}
+
+#endif // DATASET_GENERATOR_H_
@@ -0,0 +1,347 @@
+#ifndef EXTERNAL_SORT_H_
+#define EXTERNAL_SORT_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "radix_join.h"
+
+//
+// Out-of-core sort of an int stream under a fixed memory budget.
+// Values are buffered until the budget is used, radix sorted, and spilled as a
+// run to an unlinked temporary file (it disappears with the process, even on a
+// crash). The runs are then k-way merged back through small read buffers; if
+// the budget cannot hold a buffer for every run, groups of runs are merged
+// into longer ones first. That happens while spilling already, tier by tier
+// (as soon as there are FanIn() runs of one size, they become one run of the
+// next size), so the open runs, and file descriptors, stay at about FanIn()
+// per tier, logarithmic in the input, and every value is rewritten once per
+// tier. With @unique, duplicates are dropped from every run and from the
+// merged output.
+//
+
+class ExternalSorter
+{
+public:
+    // Smallest read buffer a run gets while merging, and so the smallest budget that makes sense
+    enum : size_t
+    {
+        kMinRunBuffer = 16 << 10,
+        kMinBudget = 4 * kMinRunBuffer
+    };
+
+    ExternalSorter(size_t budgetBytes, const std::string &tmpDir, bool unique)
+        : budget(std::max<size_t>(budgetBytes, kMinBudget)), tmpDir(tmpDir), unique(unique), failed(false),
+          memoryPos(0), haveLast(false), last(0)
+    {
+    }
+    ~ExternalSorter()
+    {
+        for (const Run &run : runs)
+            ::close(run.fd);
+    }
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    // Append @value, spilling a run when the buffer is full. Returns false on an I/O error.
+    bool Add(int value)
+    {
+        // The radix sort needs a scratch copy, so a chunk gets half the budget
+        if (chunk.empty())
+            chunk.reserve(budget / (2 * sizeof(int)));
+        chunk.push_back(value);
+        if (chunk.size() == chunk.capacity())
+            return Spill();
+        return !failed;
+    }
+
+    // Done adding: merge the runs down to one pass. Returns false on an I/O error.
+    bool Finish()
+    {
+        if (runs.empty())
+        {
+            // Everything fit in memory, nothing to merge
+            SortChunk();
+            return !failed;
+        }
+        if (!chunk.empty() && !Spill())
+            return false;
+        std::vector<int>().swap(chunk);
+        while (!failed && runs.size() > FanIn())
+            MergePass();
+        if (!failed)
+            merger.reset(new Merger(runs, budget / std::max<size_t>(runs.size(), 1)));
+        return !failed;
+    }
+
+    // Store the next value in sorted order in @value, false at the end (or on an I/O error)
+    bool Next(int &value)
+    {
+        if (!merger)
+        {
+            if (memoryPos == chunk.size())
+                return false;
+            value = chunk[memoryPos++];
+            return true;
+        }
+        while (merger->Next(value))
+        {
+            if (unique && haveLast && value == last)
+                continue;
+            haveLast = true;
+            last = value;
+            return true;
+        }
+        failed = failed || merger->Failed();
+        return false;
+    }
+
+    // False once a temporary file could not be created, written or read
+    bool Ok() const { return !failed; }
+
+private:
+    struct Run
+    {
+        int fd;
+        size_t count;
+        unsigned tier; // 0 for a spilled chunk, t + 1 for a merge of runs of tier t
+    };
+
+    // Buffered sequential reader over one run
+    class RunReader
+    {
+    public:
+        RunReader(const Run &run, size_t bufferInts)
+            : fd(run.fd), offset(0), remaining(run.count), pos(0), end(0), failed(false), buffer(bufferInts)
+        {
+        }
+
+        bool Next(int &value)
+        {
+            if (pos == end && !Refill())
+                return false;
+            value = buffer[pos++];
+            return true;
+        }
+        bool Failed() const { return failed; }
+
+    private:
+        int fd;
+        off_t offset;
+        size_t remaining;
+        size_t pos;
+        size_t end;
+        bool failed;
+        std::vector<int> buffer;
+
+        bool Refill()
+        {
+            size_t n = std::min(remaining, buffer.size());
+            if (n == 0)
+                return false;
+            if (!ReadAll(fd, offset, buffer.data(), n * sizeof(int)))
+            {
+                failed = true;
+                return false;
+            }
+            offset += static_cast<off_t>(n * sizeof(int));
+            remaining -= n;
+            pos = 0;
+            end = n;
+            return true;
+        }
+    };
+
+    // Heap of the current head of every run
+    class Merger
+    {
+    public:
+        Merger(const std::vector<Run> &runs, size_t bufferBytes)
+        {
+            size_t bufferInts = std::max<size_t>(bufferBytes / sizeof(int), 1);
+            for (const Run &run : runs)
+                readers.emplace_back(new RunReader(run, bufferInts));
+            for (size_t i = 0; i < readers.size(); i++)
+                Push(i);
+        }
+
+        bool Next(int &value)
+        {
+            if (heap.empty())
+                return false;
+            value = heap.top().first;
+            size_t from = heap.top().second;
+            heap.pop();
+            Push(from);
+            return true;
+        }
+        bool Failed() const
+        {
+            for (const auto &reader : readers)
+                if (reader->Failed())
+                    return true;
+            return false;
+        }
+
+    private:
+        typedef std::pair<int, size_t> Head;
+        std::vector<std::unique_ptr<RunReader>> readers;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+
+        void Push(size_t i)
+        {
+            int value;
+            if (readers[i]->Next(value))
+                heap.push(Head(value, i));
+        }
+    };
+
+    size_t budget;
+    std::string tmpDir;
+    bool unique;
+    bool failed;
+    std::vector<int> chunk;
+    size_t memoryPos;
+    std::vector<Run> runs;
+    std::unique_ptr<Merger> merger;
+    bool haveLast;
+    int last;
+
+    // Runs merged at once: one read buffer each plus one for the output
+    size_t FanIn() const
+    {
+        return std::max<size_t>(budget / kMinRunBuffer - 1, 2);
+    }
+
+    void SortChunk()
+    {
+        radixSort(chunk);
+        if (unique)
+            chunk.erase(std::unique(chunk.begin(), chunk.end()), chunk.end());
+    }
+
+    bool Spill()
+    {
+        SortChunk();
+        Run run = {CreateTemp(), 0, 0};
+        if (run.fd < 0 || !Flush(run, chunk))
+        {
+            if (run.fd >= 0)
+                ::close(run.fd);
+            failed = true;
+            return false;
+        }
+        runs.push_back(run);
+        // Runs are kept from the highest tier down, so a full tier is always the last FanIn() runs
+        while (!failed && runs.size() >= FanIn() && runs[runs.size() - FanIn()].tier == runs.back().tier)
+            MergePass();
+        return !failed;
+    }
+
+    // Merge the last FanIn() runs into one of the next tier, which takes their place at the end of the list
+    void MergePass()
+    {
+        size_t k = FanIn();
+        size_t bufferBytes = budget / (k + 1);
+        std::vector<Run> group(runs.end() - k, runs.end());
+        runs.erase(runs.end() - k, runs.end());
+        unsigned tier = 0;
+        for (const Run &run : group)
+            tier = std::max(tier, run.tier + 1);
+        Run out = {CreateTemp(), 0, tier};
+        failed = out.fd < 0;
+        {
+            Merger merge(group, bufferBytes);
+            std::vector<int> buffer;
+            buffer.reserve(std::max<size_t>(bufferBytes / sizeof(int), 1));
+            int value;
+            bool haveLast = false;
+            int last = 0;
+            while (!failed && merge.Next(value))
+            {
+                if (unique && haveLast && value == last)
+                    continue;
+                haveLast = true;
+                last = value;
+                buffer.push_back(value);
+                if (buffer.size() == buffer.capacity())
+                    failed = !Flush(out, buffer);
+            }
+            failed = failed || merge.Failed() || !Flush(out, buffer);
+        }
+        for (const Run &run : group)
+            ::close(run.fd);
+        if (out.fd >= 0)
+            runs.push_back(out);
+    }
+
+    // Append @values to @run and empty them
+    static bool Flush(Run &run, std::vector<int> &values)
+    {
+        off_t offset = static_cast<off_t>(run.count * sizeof(int));
+        if (!WriteAll(run.fd, offset, values.data(), values.size() * sizeof(int)))
+            return false;
+        run.count += values.size();
+        values.clear();
+        return true;
+    }
+
+    // An anonymous file in tmpDir: unlinked right away, it only lives as long as the descriptor
+    int CreateTemp() const
+    {
+        std::string path = (tmpDir.empty() ? std::string(".") : tmpDir) + "/sighting_run.XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+        int fd = ::mkstemp(name.data());
+        if (fd >= 0)
+            ::unlink(name.data());
+        return fd;
+    }
+
+    static bool WriteAll(int fd, off_t offset, const int *data, size_t bytes)
+    {
+        const char *from = reinterpret_cast<const char *>(data);
+        while (bytes > 0)
+        {
+            ssize_t done = ::pwrite(fd, from, bytes, offset);
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done <= 0)
+                return false;
+            from += done;
+            offset += done;
+            bytes -= static_cast<size_t>(done);
+        }
+        return true;
+    }
+
+    static bool ReadAll(int fd, off_t offset, int *data, size_t bytes)
+    {
+        char *to = reinterpret_cast<char *>(data);
+        while (bytes > 0)
+        {
+            ssize_t done = ::pread(fd, to, bytes, offset);
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done <= 0)
+                return false;
+            to += done;
+            offset += done;
+            bytes -= static_cast<size_t>(done);
+        }
+        return true;
+    }
+};
+
+#endif // EXTERNAL_SORT_H_
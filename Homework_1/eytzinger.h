@@ -0,0 +1,75 @@
+#ifndef EYTZINGER_H_
+#define EYTZINGER_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Sorted ints rearranged in Eytzinger (BFS) order: the root is at index 1 and
+// the children of k are at 2k and 2k+1. The first levels of the implicit tree
+// share cache lines, and a search is a branchless walk down the tree that
+// prefetches the line holding its descendants four levels ahead.
+class EytzingerIndex
+{
+public:
+    // Build from @sorted (ascending)
+    // Complexity: O(N)
+    explicit EytzingerIndex(const std::vector<int> &sorted) : size(sorted.size()), tree(nullptr)
+    {
+        // Line aligned, so the 16 descendants of a node four levels down share one line
+        void *block = nullptr;
+        if (posix_memalign(&block, kLineBytes, (size + 1) * sizeof(int)) != 0)
+            throw std::bad_alloc();
+        tree = static_cast<int *>(block);
+        size_t next = 0;
+        Fill(sorted, next, 1);
+    }
+    ~EytzingerIndex()
+    {
+        free(tree);
+    }
+    EytzingerIndex(const EytzingerIndex &) = delete;
+    EytzingerIndex &operator=(const EytzingerIndex &) = delete;
+
+    // Return number of keys in index
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        return size;
+    }
+
+    // Return whether @key is in the index
+    // Complexity: O(log N), without data dependent branches
+    bool Contains(int key) const
+    {
+        size_t k = 1;
+        while (k <= size)
+        {
+            // Near the leaves this points past the array, which is fine: prefetches never fault
+            __builtin_prefetch(tree + k * kLineInts);
+            k = 2 * k + (tree[k] < key);
+        }
+        // Undo the right turns taken after the last left turn, that lands on the lower bound
+        k >>= __builtin_ffsll(~static_cast<long long>(k));
+        return k != 0 && tree[k] == key;
+    }
+
+private:
+    static const size_t kLineBytes = 64;
+    static const size_t kLineInts = kLineBytes / sizeof(int);
+
+    size_t size;
+    int *tree;
+
+    void Fill(const std::vector<int> &sorted, size_t &next, size_t k)
+    {
+        if (k > size)
+            return;
+        Fill(sorted, next, 2 * k);
+        tree[k] = sorted[next++];
+        Fill(sorted, next, 2 * k + 1);
+    }
+};
+
+#endif // EYTZINGER_H_
@@ -0,0 +1,273 @@
+#ifndef HASH_SET_H_
+#define HASH_SET_H_
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of ints stored in one flat array with open addressing (linear probing).
+// INT_MIN marks an empty slot, so that one key is tracked with a flag instead.
+class IntHashSet
+{
+public:
+    // Constructor, reserves room for about @expected keys before the first rehash
+    explicit IntHashSet(size_t expected = 16) : size(0), has_empty_key(false)
+    {
+        Allocate(CapacityFor(expected));
+    }
+
+    //
+    // Capacity
+    //
+
+    // Return number of keys in set
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        return size;
+    }
+
+    // Return true if empty, false otherwise
+    // Complexity: O(1)
+    bool Empty() const noexcept
+    {
+        return size == 0;
+    }
+
+    //
+    // Modifiers
+    //
+
+    // Insert @key, return true if it was not already in the set
+    // Complexity: O(1) expected, O(N) when the table grows
+    bool Insert(int key)
+    {
+        if (key == kEmpty)
+        {
+            if (has_empty_key)
+                return false;
+            has_empty_key = true;
+            size++;
+            return true;
+        }
+        if ((size + 1) * 2 > slots.size())
+            Grow();
+        size_t pos = Slot(key);
+        while (slots[pos] != kEmpty)
+        {
+            if (slots[pos] == key)
+                return false;
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = key;
+        size++;
+        return true;
+    }
+
+    // Remove every key, keeping the current capacity
+    // Complexity: O(capacity)
+    void Clear() noexcept
+    {
+        std::fill(slots.begin(), slots.end(), kEmpty);
+        size = 0;
+        has_empty_key = false;
+    }
+
+    //
+    // Lookup
+    //
+
+    // Return whether @key is in the set
+    // Complexity: O(1) expected
+    bool Contains(int key) const
+    {
+        if (key == kEmpty)
+            return has_empty_key;
+        size_t pos = Slot(key);
+        while (slots[pos] != kEmpty)
+        {
+            if (slots[pos] == key)
+                return true;
+            pos = (pos + 1) & mask;
+        }
+        return false;
+    }
+
+private:
+    enum : int { kEmpty = INT_MIN };
+
+    std::vector<int> slots;
+    size_t mask;
+    unsigned shift;
+    size_t size;
+    bool has_empty_key;
+
+    // Smallest power of two keeping @expected keys under half load
+    static size_t CapacityFor(size_t expected)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        return capacity;
+    }
+
+    // Fibonacci hashing: the top bits of the product are well mixed
+    size_t Slot(int key) const
+    {
+        return (static_cast<uint32_t>(key) * 2654435769u) >> shift;
+    }
+
+    void Allocate(size_t capacity)
+    {
+        slots.assign(capacity, kEmpty);
+        mask = capacity - 1;
+        shift = 32;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            shift--;
+    }
+
+    void Grow()
+    {
+        std::vector<int> old_slots;
+        old_slots.swap(slots);
+        Allocate(old_slots.size() * 2);
+        for (auto key : old_slots)
+        {
+            if (key == kEmpty)
+                continue;
+            size_t pos = Slot(key);
+            while (slots[pos] != kEmpty)
+                pos = (pos + 1) & mask;
+            slots[pos] = key;
+        }
+    }
+};
+
+// Multiplicity of each int in a stream, same flat open-addressing layout as
+// IntHashSet with a count stored next to every key (hash aggregation).
+class IntCountTable
+{
+public:
+    // Constructor, reserves room for about @expected distinct keys before the first rehash
+    explicit IntCountTable(size_t expected = 16) : size(0), empty_key_count(0)
+    {
+        Allocate(CapacityFor(expected));
+    }
+
+    // Return number of distinct keys
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        return size;
+    }
+
+    // Count one more occurrence of @key
+    // Complexity: O(1) expected, O(N) when the table grows
+    void Add(int key)
+    {
+        if (key == kEmpty)
+        {
+            size += empty_key_count == 0;
+            empty_key_count++;
+            return;
+        }
+        if ((size + 1) * 2 > slots.size())
+            Grow();
+        size_t pos = Slot(key);
+        while (slots[pos].key != kEmpty && slots[pos].key != key)
+            pos = (pos + 1) & mask;
+        if (slots[pos].key == kEmpty)
+        {
+            slots[pos].key = key;
+            size++;
+        }
+        slots[pos].count++;
+    }
+
+    // Return number of times @key was added
+    // Complexity: O(1) expected
+    uint64_t Count(int key) const
+    {
+        if (key == kEmpty)
+            return empty_key_count;
+        size_t pos = Slot(key);
+        while (slots[pos].key != kEmpty)
+        {
+            if (slots[pos].key == key)
+                return slots[pos].count;
+            pos = (pos + 1) & mask;
+        }
+        return 0;
+    }
+
+    // Call @fn(key, count) for every distinct key, in table order
+    // Complexity: O(capacity)
+    template <typename Fn>
+    void ForEach(Fn fn) const
+    {
+        if (empty_key_count)
+            fn(static_cast<int>(kEmpty), empty_key_count);
+        for (const Entry &entry : slots)
+        {
+            if (entry.key != kEmpty)
+                fn(entry.key, entry.count);
+        }
+    }
+
+private:
+    enum : int { kEmpty = INT_MIN };
+
+    struct Entry
+    {
+        int key;
+        uint64_t count;
+    };
+
+    std::vector<Entry> slots;
+    size_t mask;
+    unsigned shift;
+    size_t size;
+    uint64_t empty_key_count;
+
+    static size_t CapacityFor(size_t expected)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        return capacity;
+    }
+
+    size_t Slot(int key) const
+    {
+        return (static_cast<uint32_t>(key) * 2654435769u) >> shift;
+    }
+
+    void Allocate(size_t capacity)
+    {
+        slots.assign(capacity, Entry{kEmpty, 0});
+        mask = capacity - 1;
+        shift = 32;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            shift--;
+    }
+
+    void Grow()
+    {
+        std::vector<Entry> old_slots;
+        old_slots.swap(slots);
+        Allocate(old_slots.size() * 2);
+        for (const Entry &entry : old_slots)
+        {
+            if (entry.key == kEmpty)
+                continue;
+            size_t pos = Slot(entry.key);
+            while (slots[pos].key != kEmpty)
+                pos = (pos + 1) & mask;
+            slots[pos] = entry;
+        }
+    }
+};
+
+#endif // HASH_SET_H_
@@ -0,0 +1,180 @@
+#ifndef MATCH_ESTIMATE_H_
+#define MATCH_ESTIMATE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "hash_set.h"
+
+// What an approximate search returns: the estimated match count and an
+// interval expected to hold the exact count with probability @confidence
+struct MatchEstimate
+{
+    double count = 0;
+    double low = 0;
+    double high = 0;
+    double sightingFraction = 1;   // share of the sighting file that was read
+    double signatureFraction = 1;  // ... and of the signature file
+    double confidence = 0.95;
+    uint64_t sightings = 0;        // sightings read
+    uint64_t signatures = 0;       // signatures read
+};
+
+/*
+Name        : sampleBlocks
+Description : Picks each of @blocks blocks independently with probability @rate (at least one is picked)
+Receives    : number of blocks, the rate, seed of the draw
+Returns     : The indexes of the blocks picked, ascending.
+*/
+inline std::vector<size_t> sampleBlocks(size_t blocks, double rate, uint32_t seed)
+{
+    std::mt19937 mt(seed);
+    std::bernoulli_distribution pick(std::min(std::max(rate, 0.0), 1.0));
+    std::vector<size_t> picked;
+    for (size_t b = 0; b < blocks; b++)
+    {
+        if (pick(mt))
+            picked.push_back(b);
+    }
+    if (picked.empty() && blocks > 0)
+        picked.push_back(std::uniform_int_distribution<size_t>(0, blocks - 1)(mt));
+    return picked;
+}
+
+// Estimate of the match count from a sample of both files.
+// A signature counts when its value is among the sightings. On the sighting
+// side, every value seen in the sample is certainly in the full file, so its
+// sampled signatures are an exact part of the count. The part the sample
+// missed (values that are in the file but were never drawn) is estimated the
+// Chao1 way from the values drawn once and twice: with a sample fraction p,
+// missed = (1 - p) * once^2 / (2 * twice), where once and twice are the
+// signatures matching those values. On create_dataset files the values repeat,
+// so few are seen only once and the estimate converges to the exact count well
+// before the whole file is read. When no value was drawn twice there is nothing
+// to go by, and every sighting may well be distinct: a value seen once then
+// stands for 1 / p values (Good-Turing), missed = (1 - p) / p * once.
+// The missed part cannot be negative, so its interval is log-normal, as usual
+// for Chao1, and it cannot be more than the sampled signatures left unmatched,
+// which caps it when nearly every signature matches. On the signature side the sampled signatures are scaled by the
+// inverse of their fraction, and the spread of that sample is added to both
+// ends of the interval as a normal term.
+class MatchEstimator
+{
+public:
+    MatchEstimator() : signatures(0) {}
+
+    // Add one sampled signature
+    // Complexity: O(1) expected
+    void AddSignature(int value)
+    {
+        catalog.Add(value);
+        signatures++;
+    }
+
+    // Add one sampled sighting signature
+    // Complexity: O(1) expected
+    void AddSighting(int value)
+    {
+        seen.Add(value);
+    }
+
+    // Return the estimate for samples of a @sightingFraction of the sightings and a @signatureFraction
+    // of the signatures, with an interval at the @confidence level (such as 0.95)
+    // Complexity: O(distinct sampled sighting values)
+    MatchEstimate Estimate(double sightingFraction, double signatureFraction, double confidence = 0.95) const
+    {
+        double p = std::min(std::max(sightingFraction, 1e-12), 1.0);
+        double s = std::min(std::max(signatureFraction, 1e-12), 1.0);
+        // Signatures of the values seen once and twice, and how many such values there are
+        double found = 0, once = 0, twice = 0, onceValues = 0, twiceValues = 0, onceSquares = 0;
+        uint64_t records = 0;
+        seen.ForEach([&](int value, uint64_t times) {
+            double c = static_cast<double>(catalog.Count(value));
+            records += times;
+            found += c;
+            if (c > 0 && times <= 2)
+            {
+                (times == 1 ? once : twice) += c;
+                (times == 1 ? onceValues : twiceValues) += 1;
+                onceSquares += times == 1 ? c * c : 0;
+            }
+        });
+        double q = 1 - p;
+        double missed = 0, missedVariance = 0;
+        if (twiceValues > 0)
+        {
+            double r = onceValues / twiceValues;
+            double share = (once + twice) / (onceValues + twiceValues);
+            missed = q * once * once / (2 * twice);
+            missedVariance = q * q * share * share * twiceValues * (r * r / 2 + r * r * r + r * r * r * r / 4);
+        }
+        else
+        {
+            // No repeats to go by: every sighting may well be distinct
+            missed = q / p * once;
+            missedVariance = q / (p * p) * onceSquares;
+        }
+        // What was missed cannot be less than zero, so its interval is log-normal as usual for Chao1;
+        // the sampling of the signatures is added on top of it (normal)
+        double z = NormalQuantile(0.5 + confidence / 2);
+        double widen = missed > 0 ? std::exp(z * std::sqrt(std::log(1 + missedVariance / (missed * missed)))) : 1;
+        // Only a sampled signature that no sampled sighting matched can be among the missed matches
+        double unmatched = static_cast<double>(signatures) - found;
+        double missedLow = std::min(missed / widen, unmatched);
+        double missedHigh = std::min(missed * widen, unmatched);
+        missed = std::min(missed, unmatched);
+        double spread = z * std::sqrt((1 - s) * (found + missed)) / s;
+        MatchEstimate estimate;
+        estimate.count = (found + missed) / s;
+        estimate.low = (found + missedLow) / s - spread;
+        estimate.high = (found + missedHigh) / s + spread;
+        // With the whole signature file, the matches of the values seen are an exact floor and all of it a ceiling
+        if (s >= 1)
+            estimate.high = std::min(estimate.high, static_cast<double>(signatures));
+        estimate.low = std::max(estimate.low, s < 1 ? 0.0 : found);
+        estimate.sightingFraction = p;
+        estimate.signatureFraction = s;
+        estimate.confidence = confidence;
+        estimate.sightings = records;
+        estimate.signatures = signatures;
+        return estimate;
+    }
+
+    // Return the z such that a standard normal is below it with probability @p
+    static double NormalQuantile(double p)
+    {
+        double low = -10, high = 10;
+        for (int i = 0; i < 100; i++)
+        {
+            double mid = (low + high) / 2;
+            (0.5 * std::erfc(-mid / std::sqrt(2.0)) < p ? low : high) = mid;
+        }
+        return (low + high) / 2;
+    }
+
+private:
+    IntCountTable catalog;
+    IntCountTable seen;
+    uint64_t signatures;
+};
+
+/*
+Name        : printMatchEstimate
+Description : One line summary of @estimate: the estimated count, its interval and the samples it came from
+Receives    : output stream, the estimate
+Returns     : nothing.
+*/
+inline void printMatchEstimate(std::ostream &out, const MatchEstimate &estimate)
+{
+    out << "approx: estimate=" << std::llround(estimate.count) << " low=" << std::llround(std::floor(estimate.low))
+        << " high=" << std::llround(std::ceil(estimate.high)) << " confidence=" << estimate.confidence
+        << " sightings=" << estimate.sightings << " (" << estimate.sightingFraction << ")"
+        << " signatures=" << estimate.signatures << " (" << estimate.signatureFraction << ")" << std::endl;
+}
+
+#endif // MATCH_ESTIMATE_H_
@@ -0,0 +1,113 @@
+#ifndef PACKED_INDEX_H_
+#define PACKED_INDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Sorted ints compressed in blocks of 128 with frame-of-reference bit packing:
+// a block stores its first value, and every value as its distance from it in
+// just enough bits for the largest distance. Close values (sorted signatures
+// step by a few units) take a handful of bits instead of 32, so the index is
+// several times smaller than the vector and stays in cache when the vector
+// would not. A lookup binary-searches the small array of block minimums, then
+// searches the one block by pulling values straight out of the packed bits.
+class PackedIndex
+{
+public:
+    enum : size_t
+    {
+        kBlockValues = 128
+    };
+
+    // Build from @sorted (ascending)
+    // Complexity: O(N)
+    explicit PackedIndex(const std::vector<int> &sorted) : size(sorted.size())
+    {
+        for (size_t begin = 0; begin < size; begin += kBlockValues)
+        {
+            size_t end = std::min<size_t>(begin + kBlockValues, size);
+            uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(sorted[end - 1]) - sorted[begin]);
+            unsigned bits = 0;
+            while (bits < 32 && (range >> bits) != 0)
+                bits++;
+            mins.push_back(sorted[begin]);
+            offsets.push_back(static_cast<uint32_t>(data.size()));
+            widths.push_back(static_cast<uint8_t>(bits));
+            size_t start = data.size();
+            data.resize(start + (bits * (end - begin) + 7) / 8);
+            for (size_t i = begin; i < end; i++)
+                Put(data.data() + start, (i - begin) * bits,
+                    static_cast<uint32_t>(static_cast<int64_t>(sorted[i]) - sorted[begin]));
+        }
+        // Slack so that an 8 byte load at the last packed byte stays inside the buffer
+        data.resize(data.size() + sizeof(uint64_t), 0);
+    }
+
+    // Return number of keys in index
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        return size;
+    }
+
+    // Return size of the index in bytes: block minimums, offsets, widths and packed values
+    // Complexity: O(1)
+    size_t Bytes() const noexcept
+    {
+        return mins.size() * (sizeof(int) + sizeof(uint32_t) + sizeof(uint8_t)) + data.size();
+    }
+
+    // Return whether @key is in the index
+    // Complexity: O(log N), one block of at most 512 bytes decoded in place
+    bool Contains(int key) const
+    {
+        if (size == 0 || key < mins[0])
+            return false;
+        size_t block = std::upper_bound(mins.begin(), mins.end(), key) - mins.begin() - 1;
+        size_t count = std::min<size_t>(kBlockValues, size - block * kBlockValues);
+        const uint8_t *packed = data.data() + offsets[block];
+        unsigned bits = widths[block];
+        uint64_t mask = (uint64_t(1) << bits) - 1;
+        uint32_t target = static_cast<uint32_t>(static_cast<int64_t>(key) - mins[block]);
+        if (target > mask)
+            return false;
+        // Branchless search for the last value <= target
+        size_t base = 0;
+        while (count > 1)
+        {
+            size_t half = count / 2;
+            base = Get(packed, (base + half) * bits, mask) <= target ? base + half : base;
+            count -= half;
+        }
+        return Get(packed, base * bits, mask) == target;
+    }
+
+private:
+    size_t size;
+    std::vector<int> mins;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> widths;
+    std::vector<uint8_t> data;
+
+    // Value at bit offset @bit: one unaligned 8 byte load covers any width up to 32 plus the 7 bit shift
+    static uint32_t Get(const uint8_t *packed, size_t bit, uint64_t mask)
+    {
+        uint64_t word;
+        std::memcpy(&word, packed + bit / 8, sizeof(word));
+        return static_cast<uint32_t>((word >> (bit % 8)) & mask);
+    }
+
+    static void Put(uint8_t *packed, size_t bit, uint32_t value)
+    {
+        for (size_t b = 0; value != 0; b++, value >>= 1)
+        {
+            if (value & 1)
+                packed[(bit + b) / 8] |= static_cast<uint8_t>(1u << ((bit + b) % 8));
+        }
+    }
+};
+
+#endif // PACKED_INDEX_H_
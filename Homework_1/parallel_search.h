@@ -0,0 +1,236 @@
+#ifndef PARALLEL_SEARCH_H_
+#define PARALLEL_SEARCH_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks from one queue.
+// ParallelFor is the only entry point the searches need: it cuts a range into
+// one contiguous chunk per worker and blocks until every chunk is done.
+class ThreadPool
+{
+public:
+    // Constructor, @threads == 0 means one worker per hardware thread
+    explicit ThreadPool(unsigned threads) : stopping(false)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; i++)
+            workers.emplace_back([this] { WorkerLoop(); });
+    }
+    // Destructor, finishes queued tasks then joins the workers
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Return number of worker threads
+    size_t Size() const noexcept
+    {
+        return workers.size();
+    }
+
+    // Call @fn(begin, end, chunk) on Size() contiguous chunks covering [0, @n)
+    // Complexity: O(n / Size()) wall time if @fn is linear in its chunk
+    void ParallelFor(size_t n, const std::function<void(size_t, size_t, size_t)> &fn)
+    {
+        size_t chunks = std::min(Size(), std::max<size_t>(n, 1));
+        size_t pending = chunks;
+        std::mutex done_mutex;
+        std::condition_variable done;
+        for (size_t c = 0; c < chunks; c++)
+        {
+            size_t begin = n * c / chunks;
+            size_t end = n * (c + 1) / chunks;
+            Submit([&, begin, end, c] {
+                fn(begin, end, c);
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if (--pending == 0)
+                    done.notify_one();
+            });
+        }
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done.wait(lock, [&] { return pending == 0; });
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void Submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+/*
+Name        : parallelCount
+Description : Splits [0, n) across the pool, each worker sums its own chunk into a local count, and the
+              per-worker counts are added once at the end (no shared counter on the hot path).
+Receives    : the pool, number of items, counting function for a [begin, end) chunk
+Returns     : Total count over all chunks.
+*/
+inline int parallelCount(ThreadPool &pool, size_t n, const std::function<int(size_t, size_t)> &countChunk)
+{
+    std::vector<int> counts(pool.Size(), 0);
+    pool.ParallelFor(n, [&](size_t begin, size_t end, size_t chunk) {
+        counts[chunk] = countChunk(begin, end);
+    });
+    int total = 0;
+    for (auto c : counts)
+    {
+        total += c;
+    }
+    return total;
+}
+
+/*
+Name        : parallelProbe
+Description : Counts how many of @probes an index contains, the probes split across the pool.
+Receives    : any index with a `bool Contains(int) const`, the probes, the pool
+Returns     : Number of probes found in the index.
+*/
+template <typename Index>
+int parallelProbe(const Index &index, const std::vector<int> &probes, ThreadPool &pool)
+{
+    return parallelCount(pool, probes.size(), [&](size_t begin, size_t end) {
+        int count = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            count = count + index.Contains(probes[i]);
+        }
+        return count;
+    });
+}
+
+/*
+Name        : parallelSort
+Description : Sorts each worker's chunk with std::sort, then merges neighbouring runs pairwise,
+              every merge of a round running on its own worker.
+Receives    : vector to sort (by reference), the pool
+Returns     : nothing, @values is sorted in place.
+*/
+inline void parallelSort(std::vector<int> &values, ThreadPool &pool)
+{
+    size_t runs = std::min(pool.Size(), std::max<size_t>(values.size(), 1));
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t r = 0; r <= runs; r++)
+    {
+        bounds[r] = values.size() * r / runs;
+    }
+    pool.ParallelFor(runs, [&](size_t begin, size_t end, size_t) {
+        for (size_t r = begin; r < end; r++)
+        {
+            std::sort(values.begin() + bounds[r], values.begin() + bounds[r + 1]);
+        }
+    });
+    for (size_t width = 1; width < runs; width *= 2)
+    {
+        size_t merges = (runs + 2 * width - 1) / (2 * width);
+        pool.ParallelFor(merges, [&](size_t begin, size_t end, size_t) {
+            for (size_t m = begin; m < end; m++)
+            {
+                size_t left = m * 2 * width;
+                size_t mid = std::min(left + width, runs);
+                size_t right = std::min(left + 2 * width, runs);
+                std::inplace_merge(values.begin() + bounds[left], values.begin() + bounds[mid],
+                                   values.begin() + bounds[right]);
+            }
+        });
+    }
+}
+
+// Fixed capacity queue between the stages of a pipeline (one or more
+// producers, one or more consumers). Push blocks while the queue is full, so
+// a fast stage cannot run away from a slow one and memory stays bounded.
+template <typename T>
+class BoundedQueue
+{
+public:
+    // Constructor, at most @capacity items wait in the queue
+    explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(capacity, 1)), closed(false) {}
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Append @item, waiting for room; return false if the queue was closed
+    bool Push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Take the oldest item, waiting for one; return false once closed and drained
+    bool Pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop();
+        not_full.notify_one();
+        return true;
+    }
+
+    // No more pushes: consumers drain what is left, then Pop returns false
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed;
+    std::queue<T> items;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+};
+
+#endif // PARALLEL_SEARCH_H_
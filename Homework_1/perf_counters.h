@@ -0,0 +1,218 @@
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//
+// Hardware counters of the running process, read through Linux perf_event_open.
+// Every event is opened on its own (not as a group) so that a CPU or a
+// container exposing only some of them still reports those; the missing ones
+// show up as "n/a". Counters are inherited by threads created afterwards,
+// and the kernel folds a thread's counts into the parent's when it exits.
+//
+
+class PerfCounters
+{
+public:
+    struct Event
+    {
+        const char *name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    PerfCounters()
+    {
+        for (const Event &event : Events())
+            fds.push_back(Open(event));
+    }
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (int fd : fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // The events, in the order Read() returns them
+    static const std::vector<Event> &Events()
+    {
+#ifdef __linux__
+        static const std::vector<Event> events = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"l1d_misses", PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {"llc_misses", PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+#else
+        static const std::vector<Event> events;
+#endif
+        return events;
+    }
+
+    // Current value of each event, -1 for the ones that could not be opened
+    std::vector<int64_t> Read() const
+    {
+        std::vector<int64_t> values(fds.size(), -1);
+#ifdef __linux__
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            uint64_t value;
+            if (fds[i] >= 0 && read(fds[i], &value, sizeof(value)) == sizeof(value))
+                values[i] = static_cast<int64_t>(value);
+        }
+#endif
+        return values;
+    }
+
+    // Return true if at least one event could be opened
+    bool Available() const
+    {
+        for (int fd : fds)
+            if (fd >= 0)
+                return true;
+        return false;
+    }
+
+private:
+    std::vector<int> fds;
+
+    static int Open(const Event &event)
+    {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        return fd;
+#else
+        (void)event;
+        return -1;
+#endif
+    }
+};
+
+// Splits a run into named phases (ingest, sort, search...) and records the
+// wall time and counter deltas of each. Start() closes the current phase.
+class PhaseProfiler
+{
+public:
+    struct Phase
+    {
+        std::string name;
+        double elapsed_us;
+        std::vector<int64_t> counts;
+    };
+
+    // Close the running phase (if any) and open @name
+    void Start(const std::string &name)
+    {
+        Stop();
+        current = name;
+        start_counts = counters.Read();
+        start_time = std::chrono::steady_clock::now();
+    }
+
+    // Close the running phase, phases started again under the same name add up
+    void Stop()
+    {
+        if (current.empty())
+            return;
+        std::vector<int64_t> now = counters.Read();
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        Phase *phase = Find(current);
+        if (!phase)
+        {
+            phases.push_back(Phase{current, 0, std::vector<int64_t>(now.size(), 0)});
+            phase = &phases.back();
+        }
+        phase->elapsed_us += elapsed;
+        for (size_t i = 0; i < now.size(); i++)
+            phase->counts[i] = (now[i] < 0 || phase->counts[i] < 0) ? -1 : phase->counts[i] + now[i] - start_counts[i];
+        current.clear();
+    }
+
+    // Print one line per phase, with instructions per cycle when both are known
+    void Report(std::ostream &out) const
+    {
+        const std::vector<PerfCounters::Event> &events = PerfCounters::Events();
+        if (!counters.Available())
+            out << "perf: hardware counters unavailable (perf_event_open refused), reporting time only" << std::endl;
+        for (const Phase &phase : phases)
+        {
+            out << "perf: " << phase.name << " time_us=" << phase.elapsed_us;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                out << " " << events[i].name << "=";
+                if (phase.counts[i] < 0)
+                    out << "n/a";
+                else
+                    out << phase.counts[i];
+            }
+            if (events.size() > 1 && phase.counts[0] > 0 && phase.counts[1] >= 0)
+                out << " ipc=" << static_cast<double>(phase.counts[1]) / phase.counts[0];
+            out << std::endl;
+        }
+    }
+
+    // Same as Report, as a JSON array of objects (null for missing counters)
+    void ReportJson(std::ostream &out) const
+    {
+        const std::vector<PerfCounters::Event> &events = PerfCounters::Events();
+        out << "[" << std::endl;
+        for (size_t p = 0; p < phases.size(); p++)
+        {
+            const Phase &phase = phases[p];
+            out << "  {\"phase\": \"" << phase.name << "\", \"time_us\": " << phase.elapsed_us;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                out << ", \"" << events[i].name << "\": ";
+                if (phase.counts[i] < 0)
+                    out << "null";
+                else
+                    out << phase.counts[i];
+            }
+            out << "}" << (p + 1 < phases.size() ? "," : "") << std::endl;
+        }
+        out << "]" << std::endl;
+    }
+
+private:
+    PerfCounters counters;
+    std::vector<Phase> phases;
+    std::string current;
+    std::vector<int64_t> start_counts;
+    std::chrono::steady_clock::time_point start_time;
+
+    Phase *Find(const std::string &name)
+    {
+        for (Phase &phase : phases)
+            if (phase.name == name)
+                return &phase;
+        return nullptr;
+    }
+};
+
+#endif // PERF_COUNTERS_H_
@@ -0,0 +1,88 @@
+#ifndef RADIX_JOIN_H_
+#define RADIX_JOIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+Name        : radixSort
+Description : LSD radix sort of ints, one byte per pass, ping-ponging with a scratch buffer.
+              The sign bit is flipped so negative values order before positive ones, and a pass
+              whose byte is the same for every value is skipped.
+Receives    : vector to sort (by reference)
+Returns     : nothing, @values is sorted in place.
+*/
+inline void radixSort(std::vector<int> &values)
+{
+    const size_t n = values.size();
+    if (n < 2)
+        return;
+    std::vector<int> scratch(n);
+    int *from = values.data();
+    int *to = scratch.data();
+    for (unsigned shift = 0; shift < 32; shift += 8)
+    {
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < n; i++)
+            counts[((static_cast<uint32_t>(from[i]) ^ 0x80000000u) >> shift) & 0xff]++;
+        if (counts[((static_cast<uint32_t>(from[0]) ^ 0x80000000u) >> shift) & 0xff] == n)
+            continue;
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; b++)
+        {
+            size_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; i++)
+            to[counts[((static_cast<uint32_t>(from[i]) ^ 0x80000000u) >> shift) & 0xff]++] = from[i];
+        std::swap(from, to);
+    }
+    if (from != values.data())
+        values.swap(scratch);
+}
+
+/*
+Name        : mergeJoinCount
+Description : Walks two sorted ranges side by side and counts the equal pairs, like the nested loop of
+              linearsearch would, but in one sequential pass over each side.
+Receives    : sorted range @a of length @n, sorted range @b of length @m
+Returns     : Amount of (a, b) pairs that are equal.
+*/
+inline long long mergeJoinCount(const int *a, size_t n, const int *b, size_t m)
+{
+    long long count = 0;
+    size_t i = 0, j = 0;
+    while (i < n && j < m)
+    {
+        if (a[i] < b[j])
+        {
+            i++;
+        }
+        else if (b[j] < a[i])
+        {
+            j++;
+        }
+        else
+        {
+            int key = a[i];
+            size_t runA = 0, runB = 0;
+            while (i < n && a[i] == key)
+            {
+                i++;
+                runA++;
+            }
+            while (j < m && b[j] == key)
+            {
+                j++;
+                runB++;
+            }
+            count += static_cast<long long>(runA) * runB;
+        }
+    }
+    return count;
+}
+
+#endif // RADIX_JOIN_H_
@@ -7,196 +7,286 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include "sighting_search.h"
 
-class Time{
-    private:
-    std::chrono::high_resolution_clock::time_point start;
-    std::chrono::high_resolution_clock::time_point end;
-    public:
-    double elapsed_us;
-    void Reset(){
-        start = std::chrono::high_resolution_clock::now();
-    }
-    double CurrentTime(){
-        end = std::chrono::high_resolution_clock::now();
-        elapsed_us = std::chrono::duration<double, std::micro> (end - start).count();
-        return elapsed_us;
-    }
-};
-
-/*
-Name        : linearSearch
-Description : looks for the items that has the same signature in a linear manner
-Receives    : vector of sightings, vector of the signature
-Returns     : Amount of sightings that are the same as the signatures.
-*/
-
-int linearsearch(const std::vector<int> &sightings, const std::vector<int> &signature)
+int main(int argc, char *argv[])
 {
-    int count = 0;
-    for (auto i : sightings)
+    if (!(argv[1] && argv[2] && argv[3]))
     {
-        for (auto j : signature)
-        {
-            if (i == j)
-            {
-                count++;
-            }   
-        }
+        std::cerr << "Usage: "<< argv[0] <<" <sighting_file.dat> <signature_file.dat> <result_file.dat> [options]" << std::endl
+                  << "Options:" << std::endl
+                  << "  --ingest=hash|linear   deduplicate sightings with a hash set (default) or a linear scan" << std::endl
+                  << "  --loader=mmap|stream   parse the files from memory maps (default) or through ifstream" << std::endl
+                  << "                         (the mmap loader also reads binary datasets from create_dataset --binary)" << std::endl
+                  << "  --threads=N            search with N threads, 0 for one per core (default 1, serial)" << std::endl
+                  << "  --engine=NAME          binary search engine: auto (default), binary, eytzinger, bitmap, radix," << std::endl
+                  << "                         packed (bit packed blocks, for sighting sets that outgrow the cache)" << std::endl
+                  << "                         (auto uses bitmap when the sighting range is small, binary otherwise)" << std::endl
+                  << "  --prefilter[=RATE]     put a Bloom filter with false positive rate RATE (default 0.01) in front" << std::endl
+                  << "                         of the binary, eytzinger and packed engines, statistics on stderr" << std::endl
+                  << "  --simd=LEVEL           linear search kernel: auto (default), avx512, avx2, sse4.2, scalar" << std::endl
+                  << "  --search=l|b           search method, instead of asking on stdin" << std::endl
+                  << "  --histogram=FILE       also write \"<signature> <sightings with it> <hit 0|1>\" per distinct sighting" << std::endl
+                  << "                         signature to FILE (a binary dataset if FILE ends in .bin)" << std::endl
+                  << "  --approx[=RATE]        estimate the count from a random RATE share of the sighting file (default" << std::endl
+                  << "                         0.01): faster for a smaller RATE, the interval of the estimate goes to stderr" << std::endl
+                  << "  --confidence=LEVEL     with --approx, level of the interval (default 0.95)" << std::endl
+                  << "  --pipeline             read, parse and match the sighting file in overlapping stages, with" << std::endl
+                  << "                         --threads split between parsers and matchers" << std::endl
+                  << "  --batch                the sighting file is a directory (its sightings* files) or a list of" << std::endl
+                  << "                         sighting files; all of them run against one signature index, --threads" << std::endl
+                  << "                         at a time, and the result file gets one line per sighting file" << std::endl
+                  << "  --stream               read sightings continuously from the sighting file (- for stdin, or a FIFO)" << std::endl
+                  << "                         against signatures indexed once, until EOF" << std::endl
+                  << "  --every=N              with --stream, print \"<sightings> <matches>\" every N sightings" << std::endl
+                  << "  --interval=MS          with --stream, print \"<sightings> <matches>\" every MS milliseconds" << std::endl
+                  << "  --updates=FILE         with --stream, change the signatures while matching: FILE (or a FIFO) gives" << std::endl
+                  << "                         \"<count> <signature>\" pairs, a positive count adds, a negative one retires" << std::endl
+                  << "  --external[=SIZE]      out-of-core search for files larger than memory: sort chunks, spill runs" << std::endl
+                  << "                         and merge them, within a SIZE budget such as 512M (default 256M)" << std::endl
+                  << "  --tmpdir=DIR           with --external, where runs are spilled (default $TMPDIR or /tmp)" << std::endl
+                  << "  --perf[=FILE.json]     per-phase hardware counters, on stderr or as JSON. The phases are:" << std::endl
+                  << "                         default: ingest (loading both files), sort (binary engines), search" << std::endl
+                  << "                         --batch: ingest (signatures and their index), search (every sighting file)" << std::endl
+                  << "                         --stream, --pipeline: ingest (signatures), search (the sightings, read" << std::endl
+                  << "                         and matched together)" << std::endl
+                  << "                         --histogram: ingest (signatures, aggregating sightings), search (lookups)" << std::endl
+                  << "                         --approx: ingest (signature sample), search (sighting sample, estimate)" << std::endl
+                  << "                         --external: ingest (spilling sorted runs), search (merge join)" << std::endl;
+        return -1;
     }
-    return count;
-}
+    Time clock;
+    std::string sightingFile = argv[1];
+    std::string signatureFile = argv[2];
+    std::string resultFile = argv[3];
 
-int linearsearch(int search , const std::vector<int> &myVec)
-{
-    for (auto i : myVec)
+    // Optional flags after the three files
+    SearchOptions options;
+    for (int i = 4; i < argc; i++)
     {
-        if (i == search)
+        if (!parseSearchOption(argv[i], options))
         {
-            return 1;
+            std::cerr << "Error: unknown option " << argv[i] << std::endl;
+            return -1;
         }
-        
     }
-    return 0;
-}
-/*
-Name        : binrec
-Description : Looks at the middle of the sorted array, looks left to find the number if it's bigger, looks right otherwise.
-Receives    : start of the search, end of the search, the search term, and the signature array.
-Returns     : Amount of sightings that are the same as the signatures.
-*/
-int binrec(int front, int back, int search, const std::vector<int> &signatures)
-{
-    while (front <= back)
-    {
-        int mid = front + (back - front) / 2;
 
-        if (signatures[mid] == search)
+    PhaseProfiler profiler;
+    PhaseProfiler *phases = options.perf ? &profiler : nullptr;
+    if (phases)
+    {
+        phases->Start("ingest");
+    }
+    if (options.batch)
+    {
+        // One signature index for every sighting file, and one result line per file
+        std::vector<std::string> files;
+        if (!listSightingFiles(sightingFile, files))
+        {
+            return -1;
+        }
+        std::vector<int> signature = loadSignatures(signatureFile, options);
+        if (files.empty() || signature.empty())
+        {
+            if (files.empty())
+            {
+                std::cerr << "Error: no sighting files in " << sightingFile << std::endl;
+            }
+            return -1;
+        }
+        clock.Reset();
+        SignatureIndex index(std::move(signature));
+        if (phases)
         {
-            return 1;
+            phases->Start("search");
         }
-        else if (signatures[mid] < search)
+        std::vector<int> matches;
+        bool ok = batchSearch(files, index, options, matches);
+        double elapsed = clock.CurrentTime();
+        if (phases)
         {
-            front = mid + 1;
+            phases->Stop();
         }
-        else
+        for (size_t i = 0; i < files.size(); i++)
         {
-            back = mid - 1;
+            std::cout << files[i] << " " << matches[i] << std::endl;
         }
+        std::cout << "CPU time: " << elapsed << " microseconds"<< std::endl;
+        if (!ok || (phases && !reportPhases(*phases, options)))
+        {
+            return -1;
+        }
+        std::ofstream resStream(resultFile);
+        if (!resStream.is_open())
+        {
+            std::cerr << "Error: cannot open file " << resultFile << std::endl;
+            return -1;
+        }
+        for (auto match : matches)
+        {
+            resStream << match << " " << std::endl;
+        }
+        return 0;
     }
-    return 0;
-}
 
-/*
-Name        : binSearch
-Description : looks for the items that has the same signature by calling the recursive Binary Search.
-Receives    : vector of sightings, vector of the signature
-Returns     : Amount of sightings that are the same as the signatures.
-*/
-int binSearch(const std::vector<int> &sightings, const std::vector<int> &signatures)
-{
-    int count = 0;
-    for (auto i : signatures)
+    int match = 0;
+    PrefilterStats prefilter;
+    MatchEstimate estimate;
+    if (options.stream)
     {
-        count = count + binrec(0, sightings.size() - 1, i,sightings);
+        // Daemon mode: index the signatures once, then follow the sightings until EOF
+        std::vector<int> signature = loadSignatures(signatureFile, options);
+        if (signature.empty())
+        {
+            return -1;
+        }
+        int fd = sightingFile == "-" ? 0 : ::open(sightingFile.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            std::cerr << "Error: cannot open file " << sightingFile << std::endl;
+            return -1;
+        }
+        int updatesFd = -1;
+        if (!options.updates.empty())
+        {
+            // A FIFO is opened read-write so that it neither blocks here waiting for a writer nor
+            // reads as ended while there is none; the updates then last as long as the sightings
+            struct stat info;
+            bool fifo = ::stat(options.updates.c_str(), &info) == 0 && S_ISFIFO(info.st_mode);
+            updatesFd = ::open(options.updates.c_str(), fifo ? O_RDWR : O_RDONLY);
+            if (updatesFd < 0)
+            {
+                std::cerr << "Error: cannot open file " << options.updates << std::endl;
+                if (fd != 0)
+                {
+                    ::close(fd);
+                }
+                return -1;
+            }
+        }
+        StreamMatcher matcher(signature, options.searchTerm ? options.searchTerm : 'b');
+        clock.Reset();
+        if (phases)
+        {
+            phases->Start("search");
+        }
+        match = streamSightings(fd, matcher, options.every, options.intervalMs, std::cout, updatesFd);
+        if (fd != 0)
+        {
+            ::close(fd);
+        }
+        if (updatesFd >= 0)
+        {
+            ::close(updatesFd);
+        }
+        if (match < 0)
+        {
+            return -1;
+        }
     }
-    return count;
-}
-
-/*
-Name        : readFileSightings
-Description : Creates a vector of sightings which gets filled with the signature of the sighting File
-Receives    : Filename (string, by reference)
-Returns     : Vector containing int of the signatures for these sightings.
-*/
-std::vector<int> readFileSightings(const std::string &filename)
-{
-    std::vector<int> sightingSignature = {};
-    std::ifstream myFile(filename);
-    if (!myFile.is_open())
+    else if (!options.histogram.empty())
     {
-        std::cerr << "Error: cannot open file " << filename << std::endl;
-        return sightingSignature;
+        // The breakdown replaces the prompt: one aggregation pass, one index lookup per distinct signature
+        std::vector<int> signature = loadSignatures(signatureFile, options);
+        if (signature.empty())
+        {
+            return -1;
+        }
+        clock.Reset();
+        std::vector<HistogramRow> rows;
+        match = sightingHistogram(sightingFile, signature, options, rows, phases);
+        if (match < 0 || !writeHistogram(options.histogram, rows))
+        {
+            return -1;
+        }
     }
-    int speed, brightness;
-    while (myFile >> speed >> brightness)
+    else if (options.approxRate > 0)
     {
-        if (linearsearch(std::ceil(static_cast<double>(static_cast<double>(speed) * static_cast<double>(brightness) / 10)),sightingSignature)==0)
+        // Sampling skips most of the ingest, so the clock covers the whole estimate
+        clock.Reset();
+        if (!approximateSearch(sightingFile, signatureFile, options, estimate, phases))
         {
-            sightingSignature.push_back(std::ceil(static_cast<double>(static_cast<double>(speed) * static_cast<double>(brightness) / 10)));
+            return -1;
         }
+        match = static_cast<int>(std::llround(estimate.count));
     }
-    myFile.close();
-    return sightingSignature;
-}
-
-/*
-Name        : readFileSignatures
-Description : Creates a vector of sightings which gets filled with the signature of the known aircraft signatureFile
-Receives    : Filename (string, by reference)
-Returns     : Vector containing int of the signatures of the known aircrafts. .
-*/
-std::vector<int> readFileSignatures(const std::string &filename)
-{
-    std::vector<int> Signature;
-    std::ifstream myFile(filename);
-    if (!myFile.is_open())
+    else if (options.pipeline)
     {
-        std::cerr << "Error: cannot open file " << filename << std::endl;
-        return Signature;
+        // Reading, parsing and matching overlap, so the clock covers all three
+        std::vector<int> signature = loadSignatures(signatureFile, options);
+        if (signature.empty())
+        {
+            return -1;
+        }
+        clock.Reset();
+        if (phases)
+        {
+            phases->Start("search");
+        }
+        match = pipelinedSearch(sightingFile, signature, options);
+        if (match < 0)
+        {
+            return -1;
+        }
     }
-    int num;
-    while (myFile >> num)
+    else if (options.externalBudget)
     {
-        Signature.push_back(num);
+        // Out-of-core: sorting is the search here, so the clock covers the whole run
+        clock.Reset();
+        match = externalSearch(sightingFile, signatureFile, options, phases);
+        if (match < 0)
+        {
+            return -1;
+        }
     }
-    myFile.close();
-    return Signature;
-}
-
-int main(int argc, char *argv[])
-{
-    if (!(argv[1] && argv[2] && argv[3]))
+    else
     {
-        std::cerr << "Usage: "<< argv[0] <<" <sighting_file.dat> <signature_file.dat> <result_file.dat>";
-        return -1;
-    }
-    Time clock;
-    std::string sightingFile = argv[1];
-    std::string signatureFile = argv[2];
-    std::string resultFile = argv[3];
+        std::vector<int> sightings = loadSightings(sightingFile, options);
+        std::vector<int> signature = loadSignatures(signatureFile, options);
+        if (sightings.empty() || signature.empty())
+        {
+            return -1;
+        }
+        char searchTerm = options.searchTerm;
+        if (phases)
+        {
+            // Waiting on the prompt is nobody's cost
+            phases->Stop();
+        }
+        if (!searchTerm)
+        {
+            std::cout << "Choice of search method ([l]inear, [b]inary)?";
+            std::cin >> searchTerm;
+            while (searchTerm != 'l' && searchTerm != 'b')
+            {
+                std::cerr << "Incorrect choice" << std::endl;
+                std::cin >> searchTerm;
+            }
+        }
 
-    auto sightings = readFileSightings(sightingFile);
-    auto signature = readFileSignatures(signatureFile);
-    if (sightings.empty() || signature.empty())
+        // Starting clock to Measure the Search speed
+        match = runSearch(searchTerm, options, sightings, signature, clock, phases, &prefilter);
+    }
+    // Ending clock and counting the duration.
+    double elapsed = clock.CurrentTime();
+    if (phases)
     {
-        return -1;
+        phases->Stop();
     }
-    char searchTerm;
-    std::cout << "Choice of search method ([l]inear, [b]inary)?";
-    std::cin >> searchTerm;
-    while (searchTerm != 'l' && searchTerm != 'b')
+    std::cout << match << std::endl;
+    std::cout << "CPU time: " << elapsed << " microseconds"<< std::endl;
+    if (prefilter.probes > 0)
     {
-        std::cerr << "Incorrect choice" << std::endl;
-        std::cin >> searchTerm;
+        printPrefilterStats(std::cerr, prefilter);
     }
-    
-    // Starting clock to Measure the Search speed
-    int match = 0;
-    if (searchTerm =='l')
+    if (options.approxRate > 0)
     {
-        clock.Reset();
-        match = linearsearch(sightings, signature);
+        printMatchEstimate(std::cerr, estimate);
     }
-    else
+    if (phases && !reportPhases(*phases, options))
     {
-        clock.Reset();
-        std::sort(sightings.begin(),sightings.end());
-        match = binSearch(sightings, signature);
+        return -1;
     }
-    // Ending clock and counting the duration.
-    std::cout << match << std::endl;
-    std::cout << "CPU time: " << clock.CurrentTime() << " microseconds"<< std::endl;
     
     // Writing the output, taken from https://en.cppreference.com/w/cpp/io/basic_ofstream
     std::ofstream resStream(resultFile);
@@ -0,0 +1,1858 @@
+#ifndef SIGHTING_SEARCH_H_
+#define SIGHTING_SEARCH_H_
+
+#include <iostream>
+#include <atomic>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <dirent.h>
+#include "bitmap_search.h"
+#include "bloom_filter.h"
+#include "dat_reader.h"
+#include "dataset_format.h"
+#include "eytzinger.h"
+#include "external_sort.h"
+#include "hash_set.h"
+#include "match_estimate.h"
+#include "packed_index.h"
+#include "parallel_search.h"
+#include "perf_counters.h"
+#include "radix_join.h"
+#include "signature_catalog.h"
+#include "signature_kernel.h"
+#include "simd_search.h"
+
+class Time{
+    private:
+    std::chrono::high_resolution_clock::time_point start;
+    std::chrono::high_resolution_clock::time_point end;
+    public:
+    double elapsed_us;
+    void Reset(){
+        start = std::chrono::high_resolution_clock::now();
+    }
+    double CurrentTime(){
+        end = std::chrono::high_resolution_clock::now();
+        elapsed_us = std::chrono::duration<double, std::micro> (end - start).count();
+        return elapsed_us;
+    }
+};
+
+/*
+Name        : linearSearch
+Description : looks for the items that has the same signature in a linear manner
+Receives    : vector of sightings, vector of the signature
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+
+inline int linearsearch(const std::vector<int> &sightings, const std::vector<int> &signature)
+{
+    int count = 0;
+    for (auto i : sightings)
+    {
+        for (auto j : signature)
+        {
+            if (i == j)
+            {
+                count++;
+            }   
+        }
+    }
+    return count;
+}
+
+/*
+Name        : simdLinearSearch
+Description : Same count as linearsearch, computed by a vectorized kernel (see simd_search.h)
+Receives    : vector of sightings, vector of the signature, kernel picked by linearKernel()
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int simdLinearSearch(const std::vector<int> &sightings, const std::vector<int> &signature, LinearKernel kernel)
+{
+    return kernel(sightings.data(), sightings.size(), signature.data(), signature.size());
+}
+
+inline int linearsearch(int search , const std::vector<int> &myVec)
+{
+    for (auto i : myVec)
+    {
+        if (i == search)
+        {
+            return 1;
+        }
+        
+    }
+    return 0;
+}
+
+/*
+Name        : binrec
+Description : Looks at the middle of the sorted array, looks left to find the number if it's bigger, looks right otherwise.
+Receives    : start of the search, end of the search, the search term, and the signature array.
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int binrec(int front, int back, int search, const std::vector<int> &signatures)
+{
+    while (front <= back)
+    {
+        int mid = front + (back - front) / 2;
+
+        if (signatures[mid] == search)
+        {
+            return 1;
+        }
+        else if (signatures[mid] < search)
+        {
+            front = mid + 1;
+        }
+        else
+        {
+            back = mid - 1;
+        }
+    }
+    return 0;
+}
+
+/*
+Name        : binSearch
+Description : looks for the items that has the same signature by calling the recursive Binary Search.
+Receives    : vector of sightings, vector of the signature
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int binSearch(const std::vector<int> &sightings, const std::vector<int> &signatures)
+{
+    int count = 0;
+    for (auto i : signatures)
+    {
+        count = count + binrec(0, sightings.size() - 1, i,sightings);
+    }
+    return count;
+}
+
+/*
+Name        : eytzingerSearch
+Description : Same count as binSearch, but probes a copy of the sorted sightings rebuilt in Eytzinger order,
+              which keeps the top of the search tree in cache and avoids branch mispredicts.
+Receives    : vector of sorted sightings, vector of the signature
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int eytzingerSearch(const std::vector<int> &sightings, const std::vector<int> &signatures)
+{
+    EytzingerIndex index(sightings);
+    int count = 0;
+    for (auto i : signatures)
+    {
+        count = count + index.Contains(i);
+    }
+    return count;
+}
+
+/*
+Name        : packedSearch
+Description : Same count as binSearch, but probes a copy of the sorted sightings compressed into bit packed
+              blocks (see packed_index.h), small enough to stay in cache for large sighting sets.
+Receives    : vector of sorted sightings, vector of the signature
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int packedSearch(const std::vector<int> &sightings, const std::vector<int> &signatures)
+{
+    PackedIndex index(sightings);
+    int count = 0;
+    for (auto i : signatures)
+    {
+        count = count + index.Contains(i);
+    }
+    return count;
+}
+
+/*
+Name        : bitmapSearch
+Description : Same count as binSearch, but marks the sightings in a bitmap over their [min, max] range and
+              answers each signature with one bit test. Needs no sorting.
+Receives    : vector of sightings (any order), vector of the signature
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int bitmapSearch(const std::vector<int> &sightings, const std::vector<int> &signatures)
+{
+    SignatureBitmap bitmap(sightings);
+    int count = 0;
+    for (auto i : signatures)
+    {
+        count = count + bitmap.Contains(i);
+    }
+    return count;
+}
+
+/*
+Name        : radixJoinSearch
+Description : Radix sorts both sides, then counts the matches with a single merge-join pass.
+              Every access is sequential, so this wins over M binary searches once both sides are large.
+Receives    : vector of sightings, vector of the signature (both get sorted in place)
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int radixJoinSearch(std::vector<int> &sightings, std::vector<int> &signatures)
+{
+    radixSort(sightings);
+    radixSort(signatures);
+    return mergeJoinCount(sightings.data(), sightings.size(), signatures.data(), signatures.size());
+}
+
+/*
+Name        : parallelLinearSearch
+Description : simdLinearSearch with the sightings split across the pool, each worker counting its share.
+Receives    : vector of sightings, vector of the signature, the pool, kernel picked by linearKernel()
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelLinearSearch(const std::vector<int> &sightings, const std::vector<int> &signature, ThreadPool &pool,
+                         LinearKernel kernel)
+{
+    return parallelCount(pool, sightings.size(), [&](size_t begin, size_t end) {
+        return kernel(sightings.data() + begin, end - begin, signature.data(), signature.size());
+    });
+}
+
+/*
+Name        : parallelBinSearch
+Description : binSearch with the signature probes split across the pool, each worker counting its share.
+Receives    : vector of sorted sightings, vector of the signature, the pool
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelBinSearch(const std::vector<int> &sightings, const std::vector<int> &signatures, ThreadPool &pool)
+{
+    return parallelCount(pool, signatures.size(), [&](size_t begin, size_t end) {
+        int count = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            count = count + binrec(0, sightings.size() - 1, signatures[i], sightings);
+        }
+        return count;
+    });
+}
+
+/*
+Name        : parallelEytzingerSearch
+Description : eytzingerSearch with the signature probes split across the pool, each worker counting its share.
+Receives    : vector of sorted sightings, vector of the signature, the pool
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelEytzingerSearch(const std::vector<int> &sightings, const std::vector<int> &signatures, ThreadPool &pool)
+{
+    EytzingerIndex index(sightings);
+    return parallelProbe(index, signatures, pool);
+}
+
+/*
+Name        : parallelPackedSearch
+Description : packedSearch with the signature probes split across the pool, each worker counting its share.
+Receives    : vector of sorted sightings, vector of the signature, the pool
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelPackedSearch(const std::vector<int> &sightings, const std::vector<int> &signatures, ThreadPool &pool)
+{
+    PackedIndex index(sightings);
+    return parallelProbe(index, signatures, pool);
+}
+
+/*
+Name        : parallelBitmapSearch
+Description : bitmapSearch with the signature probes split across the pool, each worker counting its share.
+Receives    : vector of sightings (any order), vector of the signature, the pool
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelBitmapSearch(const std::vector<int> &sightings, const std::vector<int> &signatures, ThreadPool &pool)
+{
+    SignatureBitmap bitmap(sightings);
+    return parallelProbe(bitmap, signatures, pool);
+}
+
+/*
+Name        : parallelRadixJoinSearch
+Description : radixJoinSearch with the merge-join split across the pool. Each worker takes a slice of the
+              sorted signatures and joins it with the matching slice of sightings, found by lower_bound.
+Receives    : vector of sightings, vector of the signature (both get sorted in place), the pool
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int parallelRadixJoinSearch(std::vector<int> &sightings, std::vector<int> &signatures, ThreadPool &pool)
+{
+    pool.ParallelFor(2, [&](size_t begin, size_t end, size_t) {
+        for (size_t side = begin; side < end; side++)
+        {
+            radixSort(side == 0 ? sightings : signatures);
+        }
+    });
+    return parallelCount(pool, signatures.size(), [&](size_t begin, size_t end) {
+        // Cut on key boundaries so equal signatures never straddle two workers
+        while (begin > 0 && begin < signatures.size() && signatures[begin] == signatures[begin - 1])
+        {
+            begin++;
+        }
+        while (end < signatures.size() && end > 0 && signatures[end] == signatures[end - 1])
+        {
+            end++;
+        }
+        if (begin >= end)
+        {
+            return 0;
+        }
+        auto low = std::lower_bound(sightings.begin(), sightings.end(), signatures[begin]);
+        auto high = std::upper_bound(low, sightings.end(), signatures[end - 1]);
+        // Through data(), since @low may be end() (every sighting below the slice, or none at all)
+        const int *slice = sightings.data() + (low - sightings.begin());
+        return static_cast<int>(mergeJoinCount(slice, high - low, signatures.data() + begin, end - begin));
+    });
+}
+
+/*
+Name        : prefilteredSearch
+Description : binSearch (or eytzingerSearch, packedSearch) behind a Bloom filter over the sightings: a signature
+              the filter turns away costs one cache line, and only the ones it lets through reach the exact
+              search. With a pool, the signature probes are split across it.
+Receives    : vector of sorted sightings, vector of the signature, engine ("binary", "eytzinger" or "packed"),
+              false positive rate of the filter, the pool (nullptr for serial), statistics to fill
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int prefilteredSearch(const std::vector<int> &sightings, const std::vector<int> &signatures,
+                             const std::string &engine, double fpRate, ThreadPool *pool, PrefilterStats &stats)
+{
+    BloomFilter filter(sightings, fpRate);
+    std::unique_ptr<EytzingerIndex> index(engine == "eytzinger" ? new EytzingerIndex(sightings) : nullptr);
+    std::unique_ptr<PackedIndex> packed(engine == "packed" ? new PackedIndex(sightings) : nullptr);
+    std::atomic<long long> passed(0);
+    auto countChunk = [&](size_t begin, size_t end) {
+        int count = 0;
+        long long through = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!filter.MayContain(signatures[i]))
+            {
+                continue;
+            }
+            through++;
+            if (index)
+            {
+                count = count + index->Contains(signatures[i]);
+            }
+            else if (packed)
+            {
+                count = count + packed->Contains(signatures[i]);
+            }
+            else
+            {
+                count = count + binrec(0, sightings.size() - 1, signatures[i], sightings);
+            }
+        }
+        passed += through;
+        return count;
+    };
+    int match = pool ? parallelCount(*pool, signatures.size(), countChunk) : countChunk(0, signatures.size());
+    stats.probes = signatures.size();
+    stats.passed = passed;
+    stats.matches = match;
+    stats.bits = filter.Bits();
+    stats.hashes = filter.Hashes();
+    return match;
+}
+
+/*
+Name        : readFileSightings
+Description : Creates a vector of sightings which gets filled with the signature of the sighting File
+Receives    : Filename (string, by reference)
+Returns     : Vector containing int of the signatures for these sightings.
+*/
+inline std::vector<int> readFileSightings(const std::string &filename)
+{
+    std::vector<int> sightingSignature = {};
+    std::ifstream myFile(filename);
+    if (!myFile.is_open())
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return sightingSignature;
+    }
+    int speed, brightness;
+    while (myFile >> speed >> brightness)
+    {
+        int signature = ::sightingSignature(speed, brightness);
+        if (linearsearch(signature, sightingSignature)==0)
+        {
+            sightingSignature.push_back(signature);
+        }
+    }
+    myFile.close();
+    return sightingSignature;
+}
+
+/*
+Name        : fileLineEstimate
+Description : Guesses how many lines a .dat file has from its size, used to pre-size the ingest structures
+Receives    : Filename (string, by reference)
+Returns     : Estimated number of lines, 0 if the size cannot be read.
+*/
+inline size_t fileLineEstimate(const std::string &filename)
+{
+    std::ifstream myFile(filename, std::ios::binary | std::ios::ate);
+    if (!myFile.is_open())
+    {
+        return 0;
+    }
+    std::streamoff bytes = myFile.tellg();
+    // A sighting line such as "31 -8\n" is about 6 bytes long.
+    return bytes > 0 ? static_cast<size_t>(bytes) / 6 : 0;
+}
+
+/*
+Name        : readFileSightingsHash
+Description : Same as readFileSightings, but deduplicates through an open-addressing hash set instead of a linear scan.
+              The set is sized from the file, so it rarely needs to grow.
+Receives    : Filename (string, by reference)
+Returns     : Vector containing int of the unique signatures, in the order they were first seen.
+*/
+inline std::vector<int> readFileSightingsHash(const std::string &filename)
+{
+    std::vector<int> sightingSignature = {};
+    std::ifstream myFile(filename);
+    if (!myFile.is_open())
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return sightingSignature;
+    }
+    // Signatures are bounded, so there is no point reserving for every line of a huge file.
+    const size_t maxReserve = 1 << 22;
+    IntHashSet seen(std::min(fileLineEstimate(filename), maxReserve));
+    int speed, brightness;
+    while (myFile >> speed >> brightness)
+    {
+        int signature = ::sightingSignature(speed, brightness);
+        if (seen.Insert(signature))
+        {
+            sightingSignature.push_back(signature);
+        }
+    }
+    myFile.close();
+    return sightingSignature;
+}
+
+/*
+Name        : readFileSignatures
+Description : Creates a vector of sightings which gets filled with the signature of the known aircraft signatureFile
+Receives    : Filename (string, by reference)
+Returns     : Vector containing int of the signatures of the known aircrafts. .
+*/
+inline std::vector<int> readFileSignatures(const std::string &filename)
+{
+    std::vector<int> Signature;
+    std::ifstream myFile(filename);
+    if (!myFile.is_open())
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return Signature;
+    }
+    int num;
+    while (myFile >> num)
+    {
+        Signature.push_back(num);
+    }
+    myFile.close();
+    return Signature;
+}
+
+/*
+Name        : forEachScannedSighting
+Description : Calls @fn on the signature of every "speed brightness" pair of a text byte range, parsing a
+              batch of records at a time and deriving the batch's signatures with @derive
+Receives    : start and end of the text, the kernel, the callback
+Returns     : nothing.
+*/
+template <typename Fn>
+inline void forEachScannedSighting(const char *begin, const char *end, SignatureKernel derive, Fn fn)
+{
+    IntScanner scanner(begin, end);
+    const size_t batch = 1 << 12;
+    std::vector<int> speeds(batch), brightnesses(batch), signatures(batch);
+    size_t n = batch;
+    while (n == batch)
+    {
+        n = 0;
+        while (n < batch && scanner.Next(speeds[n]) && scanner.Next(brightnesses[n]))
+        {
+            n++;
+        }
+        derive(speeds.data(), brightnesses.data(), signatures.data(), n);
+        for (size_t i = 0; i < n; i++)
+        {
+            fn(signatures[i]);
+        }
+    }
+}
+
+/*
+Name        : forEachMappedSighting
+Description : Calls @fn on the signature of every sighting of a file, parsing the ints straight out of the
+              mmap'd file (or a read() buffer for pipes) instead of going through ifstream extraction.
+              Binary datasets (see dataset_format.h) are recognized and read from their signature column.
+              Text is parsed a batch of records at a time and the batch's signatures derived by the
+              vectorized kernel of signature_kernel.h.
+Receives    : Filename (string, by reference), widest kernel to derive the signatures with, the callback
+Returns     : false if the file cannot be read or is another kind of dataset (reported on stderr).
+*/
+template <typename Fn>
+inline bool forEachMappedSighting(const std::string &filename, SimdLevel level, Fn fn)
+{
+    DatFile file;
+    if (!file.Open(filename))
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return false;
+    }
+    if (const DatasetHeader *header = datasetHeader(file))
+    {
+        if (header->kind != kSightingsDataset || header->columns <= kSignatureColumn)
+        {
+            std::cerr << "Error: not a sightings dataset " << filename << std::endl;
+            return false;
+        }
+        const int32_t *column = datasetColumn(file, kSignatureColumn);
+        for (uint64_t i = 0; i < header->count; i++)
+        {
+            fn(column[i]);
+        }
+        return true;
+    }
+    forEachScannedSighting(file.Begin(), file.End(), signatureKernel(level), fn);
+    return true;
+}
+
+/*
+Name        : readMappedSightings
+Description : Same output as readFileSightings / readFileSightingsHash, read through forEachMappedSighting.
+Receives    : Filename (string, by reference), whether to deduplicate with the hash set or the linear scan,
+              widest kernel to derive the signatures with
+Returns     : Vector containing int of the unique signatures, in the order they were first seen.
+*/
+inline std::vector<int> readMappedSightings(const std::string &filename, bool hashIngest,
+                                            SimdLevel level = kSimdAvx512)
+{
+    std::vector<int> sightingSignature = {};
+    const size_t maxReserve = 1 << 22;
+    IntHashSet seen(hashIngest ? std::min(fileLineEstimate(filename), maxReserve) : 0);
+    bool ok = forEachMappedSighting(filename, level, [&](int signature) {
+        bool isNew = hashIngest ? seen.Insert(signature) : linearsearch(signature, sightingSignature) == 0;
+        if (isNew)
+        {
+            sightingSignature.push_back(signature);
+        }
+    });
+    if (!ok)
+    {
+        sightingSignature.clear();
+    }
+    return sightingSignature;
+}
+
+/*
+Name        : readMappedSignatures
+Description : Same as readFileSignatures, parsing straight out of the mmap'd file (or a read() buffer for pipes).
+              Binary datasets are copied out of their column in one go.
+Receives    : Filename (string, by reference)
+Returns     : Vector containing int of the signatures of the known aircrafts.
+*/
+inline std::vector<int> readMappedSignatures(const std::string &filename)
+{
+    std::vector<int> Signature;
+    DatFile file;
+    if (!file.Open(filename))
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return Signature;
+    }
+    if (const DatasetHeader *header = datasetHeader(file))
+    {
+        if (header->kind != kSignaturesDataset)
+        {
+            std::cerr << "Error: not a signatures dataset " << filename << std::endl;
+            return Signature;
+        }
+        const int32_t *column = datasetColumn(file, 0);
+        Signature.assign(column, column + header->count);
+        return Signature;
+    }
+    // A signature line such as "-39\n" is about 4 bytes long.
+    Signature.reserve(file.Length() / 4);
+    IntScanner scanner(file.Begin(), file.End());
+    int num;
+    while (scanner.Next(num))
+    {
+        Signature.push_back(num);
+    }
+    return Signature;
+}
+
+// Command line flags of sighting_search, shared with the other front ends
+struct SearchOptions
+{
+    bool hashIngest = true;
+    bool mappedLoader = true;
+    unsigned threads = 1;
+    SimdLevel simdLevel = kSimdAvx512;
+    std::string engine = "auto";
+    char searchTerm = 0;       // 'l' or 'b', 0 to ask on stdin
+    bool stream = false;
+    long long every = 0;       // --stream: report every N sightings
+    int intervalMs = 0;        // --stream: report every T milliseconds
+    bool perf = false;         // per-phase hardware counter report on stderr
+    std::string perfJson;      // ... or written to this JSON file
+    size_t externalBudget = 0; // --external: memory budget in bytes, 0 to load everything in memory
+    std::string tmpDir;        // --external: where runs are spilled, $TMPDIR or /tmp if empty
+    bool batch = false;        // the sighting argument is a directory or a list of sighting files
+    double prefilterRate = 0;  // false positive rate of the Bloom prefilter, 0 for none
+    std::string histogram;     // per-signature breakdown written to this file (.bin for binary)
+    bool pipeline = false;     // overlap reading, parsing and matching of the sighting file
+    std::string updates;       // --stream: signature updates are read from this file (or FIFO)
+    double approxRate = 0;     // --approx: fraction of the values sampled, 0 for the exact search
+    double confidence = 0.95;  // --approx: level of the reported interval
+};
+
+/*
+Name        : parseByteSize
+Description : Parses a size such as "512M", with an optional K, M or G suffix (powers of 1024)
+Receives    : the text, value to fill
+Returns     : false if the text is not a positive size.
+*/
+inline bool parseByteSize(const std::string &text, size_t &bytes)
+{
+    size_t used = 0;
+    unsigned long long value = 0;
+    try
+    {
+        value = std::stoull(text, &used);
+    }
+    catch (...)
+    {
+        return false;
+    }
+    std::string suffix = text.substr(used);
+    int shift = suffix == "" ? 0 : suffix == "K" ? 10 : suffix == "M" ? 20 : suffix == "G" ? 30 : -1;
+    if (shift < 0 || value == 0 || text[0] == '-' || value > (static_cast<size_t>(-1) >> shift))
+    {
+        return false;
+    }
+    bytes = static_cast<size_t>(value << shift);
+    return true;
+}
+
+/*
+Name        : parseThreadCount
+Description : Parses a --threads value: a plain decimal count, 0 for one per hardware thread, at most
+              4 times the hardware threads (more only adds scheduling overhead, and a huge count from a
+              typo would fail to spawn)
+Receives    : the text, value to fill
+Returns     : false if the text is not such a count.
+*/
+inline bool parseThreadCount(const std::string &text, unsigned &threads)
+{
+    if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+    unsigned long value = std::stoul(text);
+    if (value > 4 * std::max(1u, std::thread::hardware_concurrency()))
+    {
+        return false;
+    }
+    threads = static_cast<unsigned>(value);
+    return true;
+}
+
+/*
+Name        : parseSearchOption
+Description : Applies one "--flag=value" command line option to @options
+Receives    : the option text, the options to update
+Returns     : false if the option or its value is not recognized.
+*/
+inline bool parseSearchOption(const std::string &option, SearchOptions &options)
+{
+    size_t equals = option.find('=');
+    std::string name = option.substr(0, equals);
+    std::string value = equals == std::string::npos ? "" : option.substr(equals + 1);
+    try
+    {
+        if (name == "--ingest" && (value == "hash" || value == "linear"))
+            options.hashIngest = value == "hash";
+        else if (name == "--loader" && (value == "mmap" || value == "stream"))
+            options.mappedLoader = value == "mmap";
+        else if (name == "--threads")
+            return parseThreadCount(value, options.threads);
+        else if (name == "--engine" && (value == "auto" || value == "binary" || value == "eytzinger" ||
+                                        value == "bitmap" || value == "radix" || value == "packed"))
+            options.engine = value;
+        else if (name == "--simd")
+            return parseSimdLevel(value, options.simdLevel);
+        else if (name == "--search" && (value == "l" || value == "b"))
+            options.searchTerm = value[0];
+        else if (option == "--perf")
+            options.perf = true;
+        else if (name == "--perf" && !value.empty())
+        {
+            options.perf = true;
+            options.perfJson = value;
+        }
+        else if (option == "--external")
+            options.externalBudget = 256 << 20;
+        else if (name == "--external" && !value.empty())
+            return parseByteSize(value, options.externalBudget);
+        else if (name == "--tmpdir" && !value.empty())
+            options.tmpDir = value;
+        else if (option == "--prefilter")
+            options.prefilterRate = 0.01;
+        else if (name == "--prefilter" && !value.empty())
+        {
+            options.prefilterRate = std::stod(value);
+            return options.prefilterRate > 0 && options.prefilterRate < 1;
+        }
+        else if (name == "--histogram" && !value.empty())
+            options.histogram = value;
+        else if (option == "--approx")
+            options.approxRate = 0.01;
+        else if (name == "--approx" && !value.empty())
+        {
+            options.approxRate = std::stod(value);
+            return options.approxRate > 0 && options.approxRate <= 1;
+        }
+        else if (name == "--confidence" && !value.empty())
+        {
+            options.confidence = std::stod(value);
+            return options.confidence > 0 && options.confidence < 1;
+        }
+        else if (option == "--pipeline")
+            options.pipeline = true;
+        else if (option == "--batch")
+            options.batch = true;
+        else if (option == "--stream")
+            options.stream = true;
+        else if (name == "--updates" && !value.empty())
+            options.updates = value;
+        else if (name == "--every" && !value.empty())
+            options.every = std::stoll(value);
+        else if (name == "--interval" && !value.empty())
+            options.intervalMs = std::stoi(value);
+        else
+            return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
+
+/*
+Name        : reportPhases
+Description : Writes the --perf report of @profiler: a line per phase on stderr, or the JSON file of
+              --perf=FILE.json
+Receives    : the profiler, the options
+Returns     : false if the JSON file cannot be written (reported on stderr).
+*/
+inline bool reportPhases(const PhaseProfiler &profiler, const SearchOptions &options)
+{
+    if (options.perfJson.empty())
+    {
+        profiler.Report(std::cerr);
+        return true;
+    }
+    std::ofstream perfStream(options.perfJson);
+    if (!perfStream.is_open())
+    {
+        std::cerr << "Error: cannot open file " << options.perfJson << std::endl;
+        return false;
+    }
+    profiler.ReportJson(perfStream);
+    return true;
+}
+
+/*
+Name        : loadSightings
+Description : Reads the sighting file with the loader and ingest picked in @options
+Receives    : Filename, the options
+Returns     : Vector containing int of the unique signatures of the sightings.
+*/
+inline std::vector<int> loadSightings(const std::string &filename, const SearchOptions &options)
+{
+    if (options.mappedLoader)
+    {
+        return readMappedSightings(filename, options.hashIngest, options.simdLevel);
+    }
+    return options.hashIngest ? readFileSightingsHash(filename) : readFileSightings(filename);
+}
+
+/*
+Name        : loadSignatures
+Description : Reads the signature file with the loader picked in @options
+Receives    : Filename, the options
+Returns     : Vector containing int of the signatures of the known aircrafts.
+*/
+inline std::vector<int> loadSignatures(const std::string &filename, const SearchOptions &options)
+{
+    return options.mappedLoader ? readMappedSignatures(filename) : readFileSignatures(filename);
+}
+
+/*
+Name        : runSearch
+Description : Runs the search method @searchTerm with the engine, threads and kernel picked in @options.
+              @clock is reset right before the search starts (after the thread pool is up).
+              With a @profiler, explicit sorts are recorded as the "sort" phase and the rest as "search"
+              (index building inside an engine, such as the radix passes, counts as search).
+              --prefilter applies to the binary, eytzinger and packed engines; what it did goes to @prefilter.
+Receives    : 'l' or 'b', the options, vector of sightings and of signatures (may get sorted), the clock,
+              optional profiler, optional prefilter statistics
+Returns     : Amount of sightings that are the same as the signatures.
+*/
+inline int runSearch(char searchTerm, const SearchOptions &options, std::vector<int> &sightings,
+                     std::vector<int> &signature, Time &clock, PhaseProfiler *profiler = nullptr,
+                     PrefilterStats *prefilter = nullptr)
+{
+    PrefilterStats unused;
+    if (!prefilter)
+    {
+        prefilter = &unused;
+    }
+    auto phase = [profiler](const char *name) {
+        if (profiler)
+        {
+            profiler->Start(name);
+        }
+    };
+    int match = 0;
+    std::string engine = options.engine;
+    if (searchTerm == 'b' && engine == "auto")
+    {
+        // A bitmap over the sighting range when it is small enough, the sorted vector otherwise
+        engine = SignatureBitmap::Suits(sightings) ? "bitmap" : "binary";
+    }
+    if (options.threads != 1)
+    {
+        // The pool is started before the clock so only the search itself is measured.
+        ThreadPool pool(options.threads);
+        clock.Reset();
+        phase("search");
+        if (searchTerm == 'l')
+        {
+            match = parallelLinearSearch(sightings, signature, pool, linearKernel(options.simdLevel));
+        }
+        else if (engine == "bitmap")
+        {
+            match = parallelBitmapSearch(sightings, signature, pool);
+        }
+        else if (engine == "radix")
+        {
+            match = parallelRadixJoinSearch(sightings, signature, pool);
+        }
+        else
+        {
+            phase("sort");
+            parallelSort(sightings, pool);
+            phase("search");
+            if (options.prefilterRate > 0)
+            {
+                match = prefilteredSearch(sightings, signature, engine, options.prefilterRate, &pool, *prefilter);
+            }
+            else if (engine == "eytzinger")
+            {
+                match = parallelEytzingerSearch(sightings, signature, pool);
+            }
+            else if (engine == "packed")
+            {
+                match = parallelPackedSearch(sightings, signature, pool);
+            }
+            else
+            {
+                match = parallelBinSearch(sightings, signature, pool);
+            }
+        }
+    }
+    else if (searchTerm =='l' && options.simdLevel != kSimdScalar)
+    {
+        LinearKernel kernel = linearKernel(options.simdLevel);
+        clock.Reset();
+        phase("search");
+        match = simdLinearSearch(sightings, signature, kernel);
+    }
+    else if (searchTerm =='l')
+    {
+        clock.Reset();
+        phase("search");
+        match = linearsearch(sightings, signature);
+    }
+    else if (engine == "bitmap")
+    {
+        clock.Reset();
+        phase("search");
+        match = bitmapSearch(sightings, signature);
+    }
+    else if (engine == "radix")
+    {
+        clock.Reset();
+        phase("search");
+        match = radixJoinSearch(sightings, signature);
+    }
+    else
+    {
+        clock.Reset();
+        phase("sort");
+        std::sort(sightings.begin(),sightings.end());
+        phase("search");
+        if (options.prefilterRate > 0)
+        {
+            match = prefilteredSearch(sightings, signature, engine, options.prefilterRate, nullptr, *prefilter);
+        }
+        else if (engine == "eytzinger")
+        {
+            match = eytzingerSearch(sightings, signature);
+        }
+        else if (engine == "packed")
+        {
+            match = packedSearch(sightings, signature);
+        }
+        else
+        {
+            match = binSearch(sightings, signature);
+        }
+    }
+    return match;
+}
+
+/*
+Name        : scanFileInChunks
+Description : Calls @fn on every signature of a sighting file (or every value of a signature file) without
+              loading the file: text is parsed through a fixed IntStream buffer and binary datasets are read
+              column chunk by column chunk. Duplicates are not removed.
+Receives    : Filename, whether it is a sighting file, the callback (returns false to stop), widest kernel
+              to derive sighting signatures with
+Returns     : false if the file cannot be read or is the wrong kind of dataset, or if @fn stopped the scan.
+*/
+template <typename Fn>
+inline bool scanFileInChunks(const std::string &filename, bool sightings, Fn fn, SimdLevel level = kSimdAvx512)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || ::fstat(fd, &info) != 0)
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        return false;
+    }
+    bool ok = true;
+    DatasetHeader header;
+    if (::pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+        validDatasetHeader(header, static_cast<uint64_t>(info.st_size)))
+    {
+        DatasetKind kind = sightings ? kSightingsDataset : kSignaturesDataset;
+        size_t column = sightings ? kSignatureColumn : 0;
+        if (header.kind != kind || header.columns <= column)
+        {
+            std::cerr << "Error: not a " << (sightings ? "sightings" : "signatures") << " dataset " << filename << std::endl;
+            ::close(fd);
+            return false;
+        }
+        std::vector<int32_t> chunk(1 << 16);
+        off_t offset = sizeof(DatasetHeader) + column * header.count * sizeof(int32_t);
+        for (uint64_t done = 0; ok && done < header.count; )
+        {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(chunk.size(), header.count - done));
+            ok = ::pread(fd, chunk.data(), n * sizeof(int32_t), offset) == static_cast<ssize_t>(n * sizeof(int32_t));
+            for (size_t i = 0; ok && i < n; i++)
+            {
+                ok = fn(chunk[i]);
+            }
+            offset += n * sizeof(int32_t);
+            done += n;
+        }
+        ::close(fd);
+        return ok;
+    }
+    // Sighting pairs are collected in batches for the signature kernel
+    SignatureKernel derive = signatureKernel(level);
+    const size_t batch = 1 << 12;
+    std::vector<int> speeds(batch), brightnesses(batch), signatures(batch);
+    size_t n = 0;
+    auto flush = [&]() {
+        derive(speeds.data(), brightnesses.data(), signatures.data(), n);
+        for (size_t i = 0; ok && i < n; i++)
+        {
+            ok = fn(signatures[i]);
+        }
+        n = 0;
+    };
+    IntStream stream(fd);
+    int value;
+    bool haveSpeed = false;
+    while (ok)
+    {
+        while (ok && stream.Next(value))
+        {
+            if (!sightings)
+            {
+                ok = fn(value);
+            }
+            else if (!haveSpeed)
+            {
+                speeds[n] = value;
+                haveSpeed = true;
+            }
+            else
+            {
+                brightnesses[n++] = value;
+                haveSpeed = false;
+                if (n == batch)
+                {
+                    flush();
+                }
+            }
+        }
+        if (stream.Done())
+        {
+            break;
+        }
+        stream.Fill(-1);
+    }
+    if (ok)
+    {
+        flush();
+    }
+    ::close(fd);
+    return ok;
+}
+
+/*
+Name        : externalSearch
+Description : Out-of-core version of the search, for sighting files larger than memory. Both files are
+              streamed into ExternalSorters (half of --external's budget each, since both are open during the
+              merge), and the two sorted streams are merge-joined. Same count as the in-memory searches.
+              With a @profiler, run generation is recorded as "ingest" and merging as "search".
+Receives    : sighting and signature filenames, the options, optional profiler
+Returns     : Amount of sightings that are the same as the signatures, -1 on an error (already reported).
+*/
+inline int externalSearch(const std::string &sightingFile, const std::string &signatureFile,
+                          const SearchOptions &options, PhaseProfiler *profiler = nullptr)
+{
+    std::string tmpDir = options.tmpDir;
+    if (tmpDir.empty())
+    {
+        const char *env = std::getenv("TMPDIR");
+        tmpDir = env && *env ? env : "/tmp";
+    }
+    if (profiler)
+    {
+        profiler->Start("ingest");
+    }
+    ExternalSorter sightings(options.externalBudget / 2, tmpDir, true);
+    ExternalSorter signatures(options.externalBudget / 2, tmpDir, false);
+    if (!scanFileInChunks(sightingFile, true, [&](int v) { return sightings.Add(v); }, options.simdLevel) ||
+        !scanFileInChunks(signatureFile, false, [&](int v) { return signatures.Add(v); }))
+    {
+        if (!sightings.Ok() || !signatures.Ok())
+        {
+            std::cerr << "Error: cannot write temporary files in " << tmpDir << std::endl;
+        }
+        return -1;
+    }
+    if (!sightings.Finish() || !signatures.Finish())
+    {
+        std::cerr << "Error: cannot write temporary files in " << tmpDir << std::endl;
+        return -1;
+    }
+    if (profiler)
+    {
+        profiler->Start("search");
+    }
+    int match = 0;
+    int a = 0, b = 0;
+    bool haveA = sightings.Next(a);
+    bool haveB = signatures.Next(b);
+    while (haveA && haveB)
+    {
+        if (a < b)
+        {
+            haveA = sightings.Next(a);
+        }
+        else if (b < a)
+        {
+            haveB = signatures.Next(b);
+        }
+        else
+        {
+            match++;
+            haveB = signatures.Next(b);
+        }
+    }
+    if (!sightings.Ok() || !signatures.Ok())
+    {
+        std::cerr << "Error: cannot read temporary files in " << tmpDir << std::endl;
+        return -1;
+    }
+    return match;
+}
+
+// Running match count for sightings that arrive one at a time.
+// The signature side is indexed once; each sighting signature seen for the
+// first time adds the number of signatures equal to it, so after any prefix
+// of the input Matches() is what the batch search would return for it.
+// The signatures can change on the way (UpdateSignature): the count then
+// follows the catalog as it is at that point, with no re-indexing.
+class StreamMatcher
+{
+public:
+    // Index @signatures for the 'l'inear or 'b'inary strategy
+    StreamMatcher(const std::vector<int> &signatures, char strategy)
+        : signatures(strategy == 'b' ? std::vector<int>() : signatures),
+          catalog(strategy == 'b' ? signatures : std::vector<int>()), binary(strategy == 'b'), matches(0)
+    {
+    }
+
+    // Feed the signature of one sighting, return the updated match count
+    // Complexity: O(log M) for binary, O(M) for linear, on new signatures only
+    int Add(int sightingSignature)
+    {
+        if (!seen.Insert(sightingSignature))
+        {
+            return matches;
+        }
+        if (binary)
+        {
+            matches += static_cast<int>(catalog.Count(sightingSignature));
+        }
+        else
+        {
+            matches += std::count(signatures.begin(), signatures.end(), sightingSignature);
+        }
+        return matches;
+    }
+
+    // Add (@times > 0) or retire (@times < 0) signatures equal to @signature, return the updated match
+    // count. Retiring more than there are retires all of them.
+    // Complexity: O(log M) amortized for binary (see SignatureCatalog), O(M) for linear
+    int UpdateSignature(int signature, int times)
+    {
+        long long changed = times;
+        if (binary && times > 0)
+        {
+            catalog.Add(signature, times);
+        }
+        else if (binary)
+        {
+            changed = -static_cast<long long>(catalog.Remove(signature, -static_cast<long long>(times)));
+        }
+        else if (times > 0)
+        {
+            signatures.insert(signatures.end(), times, signature);
+        }
+        else
+        {
+            // Order does not matter to the linear scan, so retired signatures are swapped out
+            for (changed = 0; changed > times; changed--)
+            {
+                auto it = std::find(signatures.begin(), signatures.end(), signature);
+                if (it == signatures.end())
+                {
+                    break;
+                }
+                *it = signatures.back();
+                signatures.pop_back();
+            }
+        }
+        if (seen.Contains(signature))
+        {
+            matches += static_cast<int>(changed);
+        }
+        return matches;
+    }
+
+    int Matches() const noexcept
+    {
+        return matches;
+    }
+
+private:
+    std::vector<int> signatures;
+    SignatureCatalog catalog;
+    bool binary;
+    IntHashSet seen;
+    int matches;
+};
+
+/*
+Name        : followCatalogUpdates
+Description : Applies "<times> <signature>" pairs read from @fd to @matcher as they arrive (a positive count
+              adds signatures, a negative one retires them), holding @lock for each one, until EOF or a bad
+              pair (reported on stderr, and @failed is set). Once @stop is set, only the input already there
+              is applied.
+Receives    : file descriptor to read, the matcher, the lock shared with the sighting side, the stop flag, the
+              flag to set on a bad or truncated update (or a read error)
+Returns     : nothing.
+*/
+inline void followCatalogUpdates(int fd, StreamMatcher &matcher, std::mutex &lock, const std::atomic<bool> &stop,
+                                 std::atomic<bool> &failed)
+{
+    IntStream stream(fd);
+    int times = 0, value;
+    bool haveTimes = false;
+    bool last = false;
+    while (true)
+    {
+        while (stream.Next(value))
+        {
+            if (!haveTimes)
+            {
+                times = value;
+                haveTimes = true;
+                continue;
+            }
+            haveTimes = false;
+            std::lock_guard<std::mutex> guard(lock);
+            matcher.UpdateSignature(value, times);
+        }
+        if (stream.Done() || last)
+        {
+            break;
+        }
+        // Short waits, so that the end of the sightings is noticed; after it, only what is already there,
+        // with one more pass for the tokens the read that found nothing more completed (the last one at EOF)
+        bool stopping = stop;
+        last = !stream.Fill(stopping ? 0 : 50) && stopping;
+    }
+    if (stream.Failed() || (stream.Done() && haveTimes))
+    {
+        std::cerr << "Error: bad catalog update" << std::endl;
+        failed = true;
+    }
+}
+
+/*
+Name        : streamSightings
+Description : Reads "speed brightness" pairs from @fd until EOF, feeding them to @matcher, and prints
+              "<sightings read> <matches>" every @every records and/or every @intervalMs milliseconds.
+              With an @updatesFd, signature updates are read from it on a second thread and applied to
+              @matcher between the batches of sightings (see followCatalogUpdates).
+Receives    : file descriptor to read, the matcher, record and time reporting periods (0 disables either), output,
+              file descriptor of the catalog updates (-1 for none)
+Returns     : Final match count, -1 if the sightings or the updates have a token that is not an int or end
+              inside a pair (reported on stderr).
+*/
+inline int streamSightings(int fd, StreamMatcher &matcher, long long every, int intervalMs, std::ostream &out,
+                           int updatesFd = -1)
+{
+    std::mutex lock;
+    std::atomic<bool> stop(false);
+    std::atomic<bool> updatesFailed(false);
+    std::thread updates;
+    if (updatesFd >= 0)
+    {
+        updates = std::thread(followCatalogUpdates, updatesFd, std::ref(matcher), std::ref(lock), std::cref(stop),
+                              std::ref(updatesFailed));
+    }
+    IntStream stream(fd);
+    long long records = 0;
+    int speed = 0, value;
+    bool haveSpeed = false;
+    auto lastReport = std::chrono::steady_clock::now();
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            while (stream.Next(value))
+            {
+                if (!haveSpeed)
+                {
+                    speed = value;
+                    haveSpeed = true;
+                    continue;
+                }
+                haveSpeed = false;
+                records++;
+                matcher.Add(sightingSignature(speed, value));
+                if (every > 0 && records % every == 0)
+                {
+                    out << records << " " << matcher.Matches() << std::endl;
+                    lastReport = std::chrono::steady_clock::now();
+                }
+            }
+        }
+        if (stream.Done())
+        {
+            break;
+        }
+        int timeout = -1;
+        if (intervalMs > 0)
+        {
+            auto since = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastReport);
+            timeout = std::max(0, intervalMs - static_cast<int>(since.count()));
+        }
+        stream.Fill(timeout);
+        if (intervalMs > 0 && std::chrono::steady_clock::now() - lastReport >= std::chrono::milliseconds(intervalMs))
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            out << records << " " << matcher.Matches() << std::endl;
+            lastReport = std::chrono::steady_clock::now();
+        }
+    }
+    stop = true;
+    if (updates.joinable())
+    {
+        updates.join();
+    }
+    if (stream.Failed() || haveSpeed)
+    {
+        std::cerr << "Error: bad sighting in stream after " << records << " sightings" << std::endl;
+        return -1;
+    }
+    if (updatesFailed)
+    {
+        return -1;
+    }
+    return matcher.Matches();
+}
+
+// Signature side of the search, built once and shared read-only by any number
+// of sighting files (and threads): the distinct signatures in order, each with
+// how many times it appears in the signature file.
+class SignatureIndex
+{
+public:
+    // Index @signatures, in any order
+    // Complexity: O(M log M)
+    explicit SignatureIndex(std::vector<int> signatures)
+    {
+        std::sort(signatures.begin(), signatures.end());
+        for (size_t i = 0; i < signatures.size(); i++)
+        {
+            if (i == 0 || signatures[i] != signatures[i - 1])
+            {
+                values.push_back(signatures[i]);
+                counts.push_back(0);
+            }
+            counts.back()++;
+        }
+    }
+
+    // Return how many signatures are equal to @value
+    // Complexity: O(log M)
+    int Count(int value) const
+    {
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        return it != values.end() && *it == value ? counts[it - values.begin()] : 0;
+    }
+
+    // Return the match count of a deduplicated sighting file, as runSearch would
+    // Complexity: O(N log M)
+    int Matches(const std::vector<int> &uniqueSightings) const
+    {
+        int match = 0;
+        for (auto sighting : uniqueSightings)
+        {
+            match += Count(sighting);
+        }
+        return match;
+    }
+
+private:
+    std::vector<int> values;
+    std::vector<int> counts;
+};
+
+/*
+Name        : listSightingFiles
+Description : Expands the sighting argument of --batch. A directory gives its regular files whose name starts
+              with "sightings" (so signature files next to them are left out), sorted by name; anything else
+              is read as a list of sighting files, one path per line.
+Receives    : directory or list file, vector to fill
+Returns     : false if @path cannot be read (reported on stderr).
+*/
+inline bool listSightingFiles(const std::string &path, std::vector<std::string> &files)
+{
+    files.clear();
+    if (DIR *dir = ::opendir(path.c_str()))
+    {
+        while (struct dirent *entry = ::readdir(dir))
+        {
+            std::string name = entry->d_name;
+            std::string full = path + "/" + name;
+            struct stat info;
+            if (name.compare(0, 9, "sightings") == 0 && ::stat(full.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            {
+                files.push_back(full);
+            }
+        }
+        ::closedir(dir);
+        std::sort(files.begin(), files.end());
+        return true;
+    }
+    std::ifstream list(path);
+    if (!list.is_open())
+    {
+        std::cerr << "Error: cannot open file " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(list, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+/*
+Name        : batchSearch
+Description : Runs every file of @files against one SignatureIndex. Workers of a pool of --threads threads
+              take the next file in line as they finish one, so large and small files balance out.
+Receives    : sighting files, the signature index, the options, vector to fill with one count per file
+Returns     : false if a sighting file could not be read (reported on stderr); its count is left at -1.
+*/
+inline bool batchSearch(const std::vector<std::string> &files, const SignatureIndex &index,
+                        const SearchOptions &options, std::vector<int> &matches)
+{
+    matches.assign(files.size(), -1);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    auto worker = [&](size_t, size_t, size_t) {
+        for (size_t i = next++; i < files.size(); i = next++)
+        {
+            std::vector<int> sightings = loadSightings(files[i], options);
+            if (sightings.empty())
+            {
+                ok = false;
+                continue;
+            }
+            matches[i] = index.Matches(sightings);
+        }
+    };
+    ThreadPool pool(options.threads);
+    pool.ParallelFor(pool.Size(), worker);
+    return ok;
+}
+
+// One line of the --histogram output
+struct HistogramRow
+{
+    int signature;
+    uint64_t multiplicity;     // sightings with this signature
+    bool hit;                  // whether the signature file has it
+};
+
+/*
+Name        : sightingHistogram
+Description : Breakdown of the search per distinct sighting signature. The sighting file is read once
+              into a hash aggregation table (which also does the deduplication of the other loaders), then
+              every distinct signature is looked up once in a second table counting the signature file.
+              With a @profiler, the aggregation is recorded as "ingest" and the lookups as "search".
+Receives    : sighting filename, vector of the signature, the options, vector to fill (sorted by signature),
+              optional profiler
+Returns     : Amount of sightings that are the same as the signatures (same count as runSearch), -1 if the
+              sighting file cannot be read (reported on stderr).
+*/
+inline int sightingHistogram(const std::string &sightingFile, const std::vector<int> &signatures,
+                             const SearchOptions &options, std::vector<HistogramRow> &rows,
+                             PhaseProfiler *profiler = nullptr)
+{
+    if (profiler)
+    {
+        profiler->Start("ingest");
+    }
+    IntCountTable catalog(signatures.size());
+    for (auto signature : signatures)
+    {
+        catalog.Add(signature);
+    }
+    const size_t maxReserve = 1 << 22;
+    IntCountTable counts(std::min(fileLineEstimate(sightingFile), maxReserve));
+    if (!forEachMappedSighting(sightingFile, options.simdLevel, [&](int v) { counts.Add(v); }))
+    {
+        return -1;
+    }
+    if (profiler)
+    {
+        profiler->Start("search");
+    }
+    rows.clear();
+    rows.reserve(counts.Size());
+    int match = 0;
+    counts.ForEach([&](int signature, uint64_t multiplicity) {
+        int found = static_cast<int>(catalog.Count(signature));
+        match += found;
+        rows.push_back(HistogramRow{signature, multiplicity, found > 0});
+    });
+    std::sort(rows.begin(), rows.end(), [](const HistogramRow &a, const HistogramRow &b) { return a.signature < b.signature; });
+    return match;
+}
+
+/*
+Name        : writeHistogram
+Description : Writes the rows of sightingHistogram, as "<signature> <multiplicity> <hit>" text lines or, for
+              a filename ending in ".bin", as a binary histogram dataset (see dataset_format.h)
+Receives    : Filename, the rows
+Returns     : false if the file cannot be written (reported on stderr).
+*/
+inline bool writeHistogram(const std::string &filename, const std::vector<HistogramRow> &rows)
+{
+    bool ok;
+    if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0)
+    {
+        std::vector<int> signatures, multiplicities, hits;
+        for (const HistogramRow &row : rows)
+        {
+            signatures.push_back(row.signature);
+            multiplicities.push_back(static_cast<int>(std::min<uint64_t>(row.multiplicity, INT_MAX)));
+            hits.push_back(row.hit);
+        }
+        ok = writeDataset(filename, kHistogramDataset, {&signatures, &multiplicities, &hits});
+    }
+    else
+    {
+        std::ofstream out(filename);
+        for (const HistogramRow &row : rows)
+        {
+            out << row.signature << " " << row.multiplicity << " " << row.hit << "\n";
+        }
+        ok = out.good();
+    }
+    if (!ok)
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+    }
+    return ok;
+}
+
+/*
+Name        : pipelinedSearch
+Description : Reads, parses and matches the sighting file at the same time, in three stages joined by
+              BoundedQueues, so that for large inputs the run takes about as long as the slowest stage
+              instead of the sum of them:
+                reader   - one thread, read()s 1 MB chunks cut at the last newline (a sighting is a line);
+                           binary datasets skip the parsers and go out as blocks of their signature column
+                parsers  - turn chunks into blocks of signatures with the batch kernel
+                matchers - probe a hash table counting the signature file, keeping the signatures that hit
+              The sightings are never deduplicated as a whole: each matcher keeps the hits it saw, and the
+              hits are merged at the end, which only costs as much as there are distinct matching values.
+Receives    : sighting filename, vector of the signature, the options (--threads is split between parsers
+              and matchers, at least one each; --simd picks the kernel)
+Returns     : Amount of sightings that are the same as the signatures, -1 on a read error (reported).
+*/
+inline int pipelinedSearch(const std::string &sightingFile, const std::vector<int> &signatures,
+                           const SearchOptions &options)
+{
+    int fd = ::open(sightingFile.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || ::fstat(fd, &info) != 0)
+    {
+        std::cerr << "Error: cannot open file " << sightingFile << std::endl;
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        return -1;
+    }
+    DatasetHeader header;
+    bool binary = ::pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                  validDatasetHeader(header, static_cast<uint64_t>(info.st_size));
+    if (binary && (header.kind != kSightingsDataset || header.columns <= kSignatureColumn))
+    {
+        std::cerr << "Error: not a sightings dataset " << sightingFile << std::endl;
+        ::close(fd);
+        return -1;
+    }
+
+    IntCountTable catalog(signatures.size());
+    for (auto signature : signatures)
+    {
+        catalog.Add(signature);
+    }
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    unsigned parsers = std::max(1u, threads / 2);
+    unsigned matchers = std::max(1u, threads - parsers);
+    const size_t chunkBytes = 1 << 20;
+    BoundedQueue<std::vector<char>> chunks(2 * parsers);
+    BoundedQueue<std::vector<int>> blocks(2 * matchers);
+    std::atomic<bool> failed(false);
+    std::atomic<unsigned> parsing(parsers);
+    std::vector<std::vector<int>> hits(matchers);
+
+    std::vector<std::thread> stages;
+    stages.emplace_back([&] {
+        if (binary)
+        {
+            off_t offset = sizeof(DatasetHeader) + kSignatureColumn * header.count * sizeof(int32_t);
+            for (uint64_t done = 0; done < header.count && !failed; )
+            {
+                std::vector<int> block(static_cast<size_t>(std::min<uint64_t>(chunkBytes / sizeof(int), header.count - done)));
+                ssize_t bytes = static_cast<ssize_t>(block.size() * sizeof(int));
+                failed = failed || ::pread(fd, block.data(), bytes, offset) != bytes;
+                offset += bytes;
+                done += block.size();
+                blocks.Push(std::move(block));
+            }
+            chunks.Close();
+            return;
+        }
+        std::vector<char> carry;
+        bool eof = false;
+        while (!eof && !failed)
+        {
+            std::vector<char> chunk;
+            chunk.swap(carry);
+            size_t used = chunk.size();
+            chunk.resize(used + chunkBytes);
+            while (used < chunk.size())
+            {
+                ssize_t got = ::read(fd, chunk.data() + used, chunk.size() - used);
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got <= 0)
+                {
+                    failed = failed || got < 0;
+                    eof = true;
+                    break;
+                }
+                used += static_cast<size_t>(got);
+            }
+            // Hand out whole lines only, the partial last one starts the next chunk
+            size_t cut = used;
+            if (!eof)
+            {
+                while (cut > 0 && chunk[cut - 1] != '\n')
+                {
+                    cut--;
+                }
+                if (cut == 0)
+                {
+                    cut = used;
+                    carry.assign(chunk.begin(), chunk.begin() + used);
+                    continue;
+                }
+            }
+            carry.assign(chunk.begin() + cut, chunk.begin() + used);
+            chunk.resize(cut);
+            chunks.Push(std::move(chunk));
+        }
+        chunks.Close();
+    });
+    for (unsigned p = 0; p < parsers; p++)
+    {
+        stages.emplace_back([&] {
+            SignatureKernel derive = signatureKernel(options.simdLevel);
+            std::vector<char> chunk;
+            std::vector<int> speeds, brightnesses;
+            while (chunks.Pop(chunk))
+            {
+                IntScanner scanner(chunk.data(), chunk.data() + chunk.size());
+                speeds.clear();
+                brightnesses.clear();
+                int speed, brightness;
+                while (scanner.Next(speed) && scanner.Next(brightness))
+                {
+                    speeds.push_back(speed);
+                    brightnesses.push_back(brightness);
+                }
+                std::vector<int> block(speeds.size());
+                derive(speeds.data(), brightnesses.data(), block.data(), block.size());
+                blocks.Push(std::move(block));
+            }
+            if (--parsing == 0)
+            {
+                blocks.Close();
+            }
+        });
+    }
+    for (unsigned m = 0; m < matchers; m++)
+    {
+        stages.emplace_back([&, m] {
+            IntHashSet seen;
+            std::vector<int> block;
+            while (blocks.Pop(block))
+            {
+                for (auto signature : block)
+                {
+                    if (catalog.Count(signature) && seen.Insert(signature))
+                    {
+                        hits[m].push_back(signature);
+                    }
+                }
+            }
+        });
+    }
+    for (auto &stage : stages)
+    {
+        stage.join();
+    }
+    ::close(fd);
+    if (failed)
+    {
+        std::cerr << "Error: cannot read file " << sightingFile << std::endl;
+        return -1;
+    }
+
+    IntHashSet merged;
+    int match = 0;
+    for (const auto &matcherHits : hits)
+    {
+        for (auto signature : matcherHits)
+        {
+            if (merged.Insert(signature))
+            {
+                match += static_cast<int>(catalog.Count(signature));
+            }
+        }
+    }
+    return match;
+}
+
+const size_t kSampleRecords = 1 << 10;
+const size_t kSampleBytes = 8 << 10;
+
+/*
+Name        : forEachSampledRecord
+Description : Calls @fn on the records of blocks of kSampleRecords of @column, each block read with
+              probability @rate (see sampleBlocks())
+Receives    : the column, its number of records, the rate, seed of the draw, the callback
+Returns     : The share of the records read.
+*/
+template <typename T, typename Fn>
+inline double forEachSampledRecord(const T *column, uint64_t count, double rate, uint32_t seed, Fn fn)
+{
+    uint64_t read = 0;
+    for (auto block : sampleBlocks((count + kSampleRecords - 1) / kSampleRecords, rate, seed))
+    {
+        uint64_t end = std::min<uint64_t>((block + 1) * kSampleRecords, count);
+        for (uint64_t i = block * kSampleRecords; i < end; i++)
+        {
+            fn(column[i]);
+        }
+        read += end - block * kSampleRecords;
+    }
+    return count ? static_cast<double>(read) / count : 1;
+}
+
+/*
+Name        : forEachSampledValue
+Description : Calls @fn on a random sample of the signatures of a sighting file (as forEachMappedSighting does)
+              or of the values of a signature file. The file is cut in blocks (kSampleRecords records of a
+              binary dataset, kSampleBytes of text, a line belonging to the block it starts in) and each
+              block is read with probability @rate, see sampleBlocks().
+Receives    : Filename, whether it is a sighting file, the rate, seed of the draw, widest kernel to derive
+              sighting signatures with, the callback, share of the file read to fill
+Returns     : false if the file cannot be read or is the wrong kind of dataset (reported on stderr).
+*/
+template <typename Fn>
+inline bool forEachSampledValue(const std::string &filename, bool sightings, double rate, uint32_t seed,
+                                SimdLevel level, Fn fn, double &fraction)
+{
+    DatFile file;
+    if (!file.Open(filename))
+    {
+        std::cerr << "Error: cannot open file " << filename << std::endl;
+        return false;
+    }
+    if (const DatasetHeader *header = datasetHeader(file))
+    {
+        DatasetKind kind = sightings ? kSightingsDataset : kSignaturesDataset;
+        size_t columnIndex = sightings ? kSignatureColumn : 0;
+        if (header->kind != kind || header->columns <= columnIndex)
+        {
+            std::cerr << "Error: not a " << (sightings ? "sightings" : "signatures") << " dataset " << filename << std::endl;
+            return false;
+        }
+        fraction = forEachSampledRecord(datasetColumn(file, columnIndex), header->count, rate, seed, fn);
+        return true;
+    }
+    SignatureKernel derive = signatureKernel(level);
+    size_t length = file.Length();
+    size_t read = 0;
+    for (auto block : sampleBlocks((length + kSampleBytes - 1) / kSampleBytes, rate, seed))
+    {
+        // Both ends move past the next newline, so every line goes to the block it starts in
+        const char *begin = file.Begin() + block * kSampleBytes;
+        const char *end = file.Begin() + std::min(length, (block + 1) * kSampleBytes);
+        if (block > 0)
+        {
+            const char *newline = std::find(begin - 1, file.End(), '\n');
+            begin = newline == file.End() ? newline : newline + 1;
+        }
+        end = std::min(std::find(end - 1, file.End(), '\n') + 1, file.End());
+        if (begin < end && sightings)
+        {
+            forEachScannedSighting(begin, end, derive, fn);
+        }
+        else if (begin < end)
+        {
+            IntScanner scanner(begin, end);
+            int value;
+            while (scanner.Next(value))
+            {
+                fn(value);
+            }
+        }
+        read += std::min(length, (block + 1) * kSampleBytes) - block * kSampleBytes;
+    }
+    fraction = length ? static_cast<double>(read) / length : 1;
+    return true;
+}
+
+/*
+Name        : approximateSearch
+Description : Estimate of the search for when a quick figure is enough: only a --approx share of each file is
+              read (forEachSampledValue), and MatchEstimator (see match_estimate.h) turns what it found into
+              an estimate with an interval. With a @profiler, sampling the signatures is recorded as "ingest",
+              sampling the sightings and estimating as "search".
+Receives    : sighting and signature filenames, the options (--approx rate, --confidence), estimate to fill,
+              optional profiler
+Returns     : false if a file cannot be read (reported on stderr).
+*/
+inline bool approximateSearch(const std::string &sightingFile, const std::string &signatureFile,
+                              const SearchOptions &options, MatchEstimate &estimate,
+                              PhaseProfiler *profiler = nullptr)
+{
+    MatchEstimator estimator;
+    std::random_device seeds;
+    double sightingFraction = 0, signatureFraction = 0;
+    if (profiler)
+    {
+        profiler->Start("ingest");
+    }
+    if (!forEachSampledValue(signatureFile, false, options.approxRate, seeds(), options.simdLevel,
+                             [&](int v) { estimator.AddSignature(v); }, signatureFraction))
+    {
+        return false;
+    }
+    if (profiler)
+    {
+        profiler->Start("search");
+    }
+    if (!forEachSampledValue(sightingFile, true, options.approxRate, seeds(), options.simdLevel,
+                             [&](int v) { estimator.AddSighting(v); }, sightingFraction))
+    {
+        return false;
+    }
+    estimate = estimator.Estimate(sightingFraction, signatureFraction, options.confidence);
+    return true;
+}
+
+#endif // SIGHTING_SEARCH_H_
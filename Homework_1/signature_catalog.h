@@ -0,0 +1,141 @@
+#ifndef SIGNATURE_CATALOG_H_
+#define SIGNATURE_CATALOG_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Signature multiset that stays searchable while signatures are added and
+// retired. Lookups go to a sorted array of the distinct signatures with their
+// counts (the layout binary search wants) and to a small ordered map of the
+// changes made since the array was built. Once the changes outgrow a
+// sixteenth of the array they are merged into a new one in a single linear
+// pass, so an update costs O(log N) plus O(1) amortized instead of a re-sort.
+class SignatureCatalog
+{
+public:
+    enum : size_t
+    {
+        kMinChanges = 256
+    };
+
+    // Catalog of @signatures, in any order
+    // Complexity: O(M log M)
+    explicit SignatureCatalog(std::vector<int> signatures) : total(signatures.size())
+    {
+        std::sort(signatures.begin(), signatures.end());
+        for (size_t i = 0; i < signatures.size(); i++)
+        {
+            if (i == 0 || signatures[i] != signatures[i - 1])
+            {
+                values.push_back(signatures[i]);
+                counts.push_back(0);
+            }
+            counts.back()++;
+        }
+    }
+
+    // Return number of signatures, duplicates included
+    // Complexity: O(1)
+    uint64_t Size() const noexcept
+    {
+        return total;
+    }
+
+    // Return number of changes not merged into the sorted array yet
+    // Complexity: O(1)
+    size_t Pending() const noexcept
+    {
+        return changes.size();
+    }
+
+    // Return number of signatures equal to @value
+    // Complexity: O(log N)
+    uint64_t Count(int value) const
+    {
+        int64_t count = 0;
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        if (it != values.end() && *it == value)
+            count = static_cast<int64_t>(counts[it - values.begin()]);
+        auto change = changes.find(value);
+        if (change != changes.end())
+            count += change->second;
+        return static_cast<uint64_t>(count);
+    }
+
+    // Add @times signatures equal to @value
+    // Complexity: O(log N) amortized
+    void Add(int value, uint64_t times = 1)
+    {
+        Change(value, static_cast<int64_t>(times));
+    }
+
+    // Retire up to @times signatures equal to @value, return how many there were to retire
+    // Complexity: O(log N) amortized
+    uint64_t Remove(int value, uint64_t times = 1)
+    {
+        times = std::min(times, Count(value));
+        if (times > 0)
+            Change(value, -static_cast<int64_t>(times));
+        return times;
+    }
+
+    // Merge the pending changes into the sorted array
+    // Complexity: O(N + changes)
+    void Compact()
+    {
+        std::vector<int> mergedValues;
+        std::vector<uint64_t> mergedCounts;
+        mergedValues.reserve(values.size() + changes.size());
+        mergedCounts.reserve(values.size() + changes.size());
+        size_t i = 0;
+        auto change = changes.begin();
+        while (i < values.size() || change != changes.end())
+        {
+            int value;
+            int64_t count = 0;
+            if (change == changes.end() || (i < values.size() && values[i] < change->first))
+            {
+                value = values[i];
+                count = static_cast<int64_t>(counts[i++]);
+            }
+            else
+            {
+                value = change->first;
+                count = change->second;
+                if (i < values.size() && values[i] == value)
+                    count += static_cast<int64_t>(counts[i++]);
+                ++change;
+            }
+            if (count > 0)
+            {
+                mergedValues.push_back(value);
+                mergedCounts.push_back(static_cast<uint64_t>(count));
+            }
+        }
+        values.swap(mergedValues);
+        counts.swap(mergedCounts);
+        changes.clear();
+    }
+
+private:
+    std::vector<int> values;
+    std::vector<uint64_t> counts;
+    std::map<int, int64_t> changes;
+    uint64_t total;
+
+    void Change(int value, int64_t delta)
+    {
+        int64_t &pending = changes[value];
+        pending += delta;
+        if (pending == 0)
+            changes.erase(value);
+        total += delta;
+        if (changes.size() > std::max<size_t>(kMinChanges, values.size() / 16))
+            Compact();
+    }
+};
+
+#endif // SIGNATURE_CATALOG_H_
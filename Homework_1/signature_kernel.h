@@ -0,0 +1,156 @@
+#ifndef SIGNATURE_KERNEL_H_
+#define SIGNATURE_KERNEL_H_
+
+#include <cstddef>
+
+#include "dataset_format.h"
+#include "simd_search.h"
+
+//
+// Batched derivation of sighting signatures from the speed and brightness columns.
+// Same integer ceil-division as sightingSignature(), 4, 8 or 16 records at a time
+// and without touching the FPU:
+//   p = speed * brightness           (32-bit multiply)
+//   q = p / 10, truncated            (multiply-high by the magic 0x66666667, then a shift)
+//   signature = q + (p - 10q > 0)
+// The 32-bit product is exact as long as both inputs fit in 16 bits, which the
+// datasets always do; a vector holding anything wider falls back to
+// sightingSignature() for its records, so the output is the same for any input.
+//
+
+typedef void (*SignatureKernel)(const int *speeds, const int *brightnesses, int *signatures, size_t n);
+
+/*
+Name        : signatureKernelScalar
+Description : Reference kernel, one record per iteration
+Receives    : speed column, brightness column, output column, number of records
+Returns     : nothing, fills @signatures.
+*/
+inline void signatureKernelScalar(const int *speeds, const int *brightnesses, int *signatures, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        signatures[i] = sightingSignature(speeds[i], brightnesses[i]);
+    }
+}
+
+#ifdef SIMD_SEARCH_X86
+
+__attribute__((target("sse4.2"))) inline void signatureKernelSse42(const int *speeds, const int *brightnesses, int *signatures, size_t n)
+{
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i wide = _mm_set1_epi32(static_cast<int>(0xffff0000u));
+    const __m128i magic = _mm_set1_epi32(0x66666667);
+    const __m128i ten = _mm_set1_epi32(10);
+    size_t blocked = n & ~static_cast<size_t>(3);
+    for (size_t i = 0; i < blocked; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(speeds + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(brightnesses + i));
+        if (!_mm_testz_si128(_mm_or_si128(_mm_add_epi32(s, bias), _mm_add_epi32(b, bias)), wide))
+        {
+            signatureKernelScalar(speeds + i, brightnesses + i, signatures + i, 4);
+            continue;
+        }
+        __m128i p = _mm_mullo_epi32(s, b);
+        __m128i even = _mm_srli_epi64(_mm_mul_epi32(p, magic), 32);
+        __m128i odd = _mm_mul_epi32(_mm_srli_epi64(p, 32), magic);
+        __m128i high = _mm_blend_epi16(even, odd, 0xcc);
+        __m128i q = _mm_sub_epi32(_mm_srai_epi32(high, 2), _mm_srai_epi32(p, 31));
+        __m128i r = _mm_sub_epi32(p, _mm_mullo_epi32(q, ten));
+        __m128i up = _mm_cmpgt_epi32(r, _mm_setzero_si128());
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(signatures + i), _mm_sub_epi32(q, up));
+    }
+    signatureKernelScalar(speeds + blocked, brightnesses + blocked, signatures + blocked, n - blocked);
+}
+
+__attribute__((target("avx2"))) inline void signatureKernelAvx2(const int *speeds, const int *brightnesses, int *signatures, size_t n)
+{
+    const __m256i bias = _mm256_set1_epi32(0x8000);
+    const __m256i wide = _mm256_set1_epi32(static_cast<int>(0xffff0000u));
+    const __m256i magic = _mm256_set1_epi32(0x66666667);
+    const __m256i ten = _mm256_set1_epi32(10);
+    size_t blocked = n & ~static_cast<size_t>(7);
+    for (size_t i = 0; i < blocked; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(speeds + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(brightnesses + i));
+        if (!_mm256_testz_si256(_mm256_or_si256(_mm256_add_epi32(s, bias), _mm256_add_epi32(b, bias)), wide))
+        {
+            signatureKernelScalar(speeds + i, brightnesses + i, signatures + i, 8);
+            continue;
+        }
+        __m256i p = _mm256_mullo_epi32(s, b);
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(p, magic), 32);
+        __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(p, 32), magic);
+        __m256i high = _mm256_blend_epi32(even, odd, 0xaa);
+        __m256i q = _mm256_sub_epi32(_mm256_srai_epi32(high, 2), _mm256_srai_epi32(p, 31));
+        __m256i r = _mm256_sub_epi32(p, _mm256_mullo_epi32(q, ten));
+        __m256i up = _mm256_cmpgt_epi32(r, _mm256_setzero_si256());
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(signatures + i), _mm256_sub_epi32(q, up));
+    }
+    signatureKernelScalar(speeds + blocked, brightnesses + blocked, signatures + blocked, n - blocked);
+}
+
+// GCC 12 flags _mm512_undefined_epi32() inside its own shift and multiply intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f"))) inline void signatureKernelAvx512(const int *speeds, const int *brightnesses, int *signatures, size_t n)
+{
+    const __m512i bias = _mm512_set1_epi32(0x8000);
+    const __m512i wide = _mm512_set1_epi32(static_cast<int>(0xffff0000u));
+    const __m512i magic = _mm512_set1_epi32(0x66666667);
+    const __m512i ten = _mm512_set1_epi32(10);
+    const __m512i one = _mm512_set1_epi32(1);
+    for (size_t i = 0; i < n; i += 16)
+    {
+        // The tail goes through masked loads and stores instead of a scalar loop
+        __mmask16 lanes = n - i >= 16 ? static_cast<__mmask16>(0xffff) : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512i s = _mm512_maskz_loadu_epi32(lanes, speeds + i);
+        __m512i b = _mm512_maskz_loadu_epi32(lanes, brightnesses + i);
+        if (_mm512_test_epi32_mask(_mm512_or_si512(_mm512_add_epi32(s, bias), _mm512_add_epi32(b, bias)), wide))
+        {
+            signatureKernelScalar(speeds + i, brightnesses + i, signatures + i, n - i >= 16 ? 16 : n - i);
+            continue;
+        }
+        __m512i p = _mm512_mullo_epi32(s, b);
+        __m512i even = _mm512_srli_epi64(_mm512_mul_epi32(p, magic), 32);
+        __m512i odd = _mm512_mul_epi32(_mm512_srli_epi64(p, 32), magic);
+        __m512i high = _mm512_mask_blend_epi32(0xaaaa, even, odd);
+        __m512i q = _mm512_sub_epi32(_mm512_srai_epi32(high, 2), _mm512_srai_epi32(p, 31));
+        __m512i r = _mm512_sub_epi32(p, _mm512_mullo_epi32(q, ten));
+        __mmask16 up = _mm512_cmpgt_epi32_mask(r, _mm512_setzero_si512());
+        _mm512_mask_storeu_epi32(signatures + i, lanes, _mm512_mask_add_epi32(q, up, q, one));
+    }
+}
+#pragma GCC diagnostic pop
+
+#endif // SIMD_SEARCH_X86
+
+/*
+Name        : signatureKernel
+Description : Picks the derivation kernel for @level, clamped to what the CPU supports
+Receives    : wanted level (kSimdAvx512 to get the widest available)
+Returns     : The kernel function.
+*/
+inline SignatureKernel signatureKernel(SimdLevel level = kSimdAvx512)
+{
+    static const SimdLevel supported = supportedSimdLevel();
+    if (level > supported)
+        level = supported;
+    switch (level)
+    {
+#ifdef SIMD_SEARCH_X86
+    case kSimdAvx512:
+        return signatureKernelAvx512;
+    case kSimdAvx2:
+        return signatureKernelAvx2;
+    case kSimdSse42:
+        return signatureKernelSse42;
+#endif
+    default:
+        return signatureKernelScalar;
+    }
+}
+
+#endif // SIGNATURE_KERNEL_H_
@@ -0,0 +1,197 @@
+#ifndef SIMD_SEARCH_H_
+#define SIMD_SEARCH_H_
+
+#include <cstddef>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SEARCH_X86 1
+#endif
+
+//
+// Vectorized kernels for the nested loop of linear search.
+// Each signature is broadcast into a register and compared against 4, 8 or 16
+// sightings per instruction; the comparison mask is popcounted into the count.
+// Every kernel is compiled for its own ISA with a target attribute, and
+// linearKernel() picks the widest one the running CPU supports.
+//
+
+enum SimdLevel
+{
+    kSimdScalar = 0,
+    kSimdSse42 = 1,
+    kSimdAvx2 = 2,
+    kSimdAvx512 = 3
+};
+
+typedef int (*LinearKernel)(const int *sightings, size_t n, const int *signatures, size_t m);
+
+/*
+Name        : linearKernelScalar
+Description : Reference kernel, one pair of ints per iteration
+Receives    : sightings array and length, signatures array and length
+Returns     : Amount of (sighting, signature) pairs that are equal.
+*/
+inline int linearKernelScalar(const int *sightings, size_t n, const int *signatures, size_t m)
+{
+    int count = 0;
+    for (size_t j = 0; j < m; j++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            count += sightings[i] == signatures[j];
+        }
+    }
+    return count;
+}
+
+#ifdef SIMD_SEARCH_X86
+
+__attribute__((target("sse4.2,popcnt"))) inline int linearKernelSse42(const int *sightings, size_t n, const int *signatures, size_t m)
+{
+    int count = 0;
+    size_t blocked = n & ~static_cast<size_t>(3);
+    for (size_t j = 0; j < m; j++)
+    {
+        __m128i key = _mm_set1_epi32(signatures[j]);
+        for (size_t i = 0; i < blocked; i += 4)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sightings + i));
+            count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, key))));
+        }
+        for (size_t i = blocked; i < n; i++)
+        {
+            count += sightings[i] == signatures[j];
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2,popcnt"))) inline int linearKernelAvx2(const int *sightings, size_t n, const int *signatures, size_t m)
+{
+    int count = 0;
+    size_t blocked = n & ~static_cast<size_t>(7);
+    for (size_t j = 0; j < m; j++)
+    {
+        __m256i key = _mm256_set1_epi32(signatures[j]);
+        for (size_t i = 0; i < blocked; i += 8)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sightings + i));
+            count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, key))));
+        }
+        for (size_t i = blocked; i < n; i++)
+        {
+            count += sightings[i] == signatures[j];
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx512f,popcnt"))) inline int linearKernelAvx512(const int *sightings, size_t n, const int *signatures, size_t m)
+{
+    int count = 0;
+    size_t blocked = n & ~static_cast<size_t>(15);
+    for (size_t j = 0; j < m; j++)
+    {
+        __m512i key = _mm512_set1_epi32(signatures[j]);
+        for (size_t i = 0; i < blocked; i += 16)
+        {
+            __m512i block = _mm512_loadu_si512(sightings + i);
+            count += __builtin_popcount(_mm512_cmpeq_epi32_mask(block, key));
+        }
+        // The tail goes through a masked load instead of a scalar loop
+        if (blocked < n)
+        {
+            __mmask16 tail = static_cast<__mmask16>((1u << (n - blocked)) - 1);
+            __m512i block = _mm512_maskz_loadu_epi32(tail, sightings + blocked);
+            count += __builtin_popcount(_mm512_mask_cmpeq_epi32_mask(tail, block, key));
+        }
+    }
+    return count;
+}
+
+#endif // SIMD_SEARCH_X86
+
+/*
+Name        : supportedSimdLevel
+Description : Asks the running CPU which of the kernels it can execute
+Receives    : nothing
+Returns     : Widest supported level.
+*/
+inline SimdLevel supportedSimdLevel()
+{
+#ifdef SIMD_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt"))
+        return kSimdAvx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return kSimdAvx2;
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+        return kSimdSse42;
+#endif
+    return kSimdScalar;
+}
+
+/*
+Name        : linearKernel
+Description : Picks the kernel for @level, clamped to what the CPU supports
+Receives    : wanted level (kSimdAvx512 to get the widest available)
+Returns     : The kernel function.
+*/
+inline LinearKernel linearKernel(SimdLevel level = kSimdAvx512)
+{
+    static const SimdLevel supported = supportedSimdLevel();
+    if (level > supported)
+        level = supported;
+    switch (level)
+    {
+#ifdef SIMD_SEARCH_X86
+    case kSimdAvx512:
+        return linearKernelAvx512;
+    case kSimdAvx2:
+        return linearKernelAvx2;
+    case kSimdSse42:
+        return linearKernelSse42;
+#endif
+    default:
+        return linearKernelScalar;
+    }
+}
+
+// Name of a level as used on the command line
+inline std::string simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case kSimdAvx512:
+        return "avx512";
+    case kSimdAvx2:
+        return "avx2";
+    case kSimdSse42:
+        return "sse4.2";
+    default:
+        return "scalar";
+    }
+}
+
+// Reverse of simdLevelName, "auto" meaning the widest level; false if @name is unknown
+inline bool parseSimdLevel(const std::string &name, SimdLevel &level)
+{
+    for (int l = kSimdScalar; l <= kSimdAvx512; l++)
+    {
+        if (name == simdLevelName(static_cast<SimdLevel>(l)))
+        {
+            level = static_cast<SimdLevel>(l);
+            return true;
+        }
+    }
+    if (name == "auto")
+    {
+        level = kSimdAvx512;
+        return true;
+    }
+    return false;
+}
+
+#endif // SIMD_SEARCH_H_
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+// Helper: absolute path of the create_dataset binary next to this test
+static std::string createDataset() {
+    char cwd[4096];
+    EXPECT_NE(::getcwd(cwd, sizeof(cwd)), nullptr);
+    return std::string(cwd) + "/create_dataset";
+}
+
+// Helper: exit status of create_dataset run in @dir with @args, output discarded
+static int runCreateDataset(const std::string &dir, const std::string &args) {
+    std::string command = "cd " + dir + " && " + createDataset() + " " + args + " >/dev/null 2>&1";
+    int status = std::system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Helper: contents of file @name, empty if it cannot be read
+static std::string readFile(const std::string &name) {
+    std::ifstream in(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Test Case: With a seed the parallel generator writes the same bytes whatever the thread count
+TEST(CreateDatasetTest, ThreadCountDoesNotChangeOutput) {
+    char dir[] = "/tmp/test_create_dataset.XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    // Several generator blocks of sightings, so threads really split the work
+    for (std::string format : {"--binary", ""}) {
+        std::string ext = format.empty() ? ".dat" : ".bin";
+        std::vector<std::string> sightings, signatures;
+        for (std::string threads : {"1", "2", "3", "0"}) {
+            std::string suffix = "t" + threads;
+            ASSERT_EQ(runCreateDataset(dir, "200000 70000 " + suffix + " 7 " + format + " --threads=" + threads), 0);
+            std::string sightingsName = std::string(dir) + "/sightings_" + suffix + ext;
+            std::string signaturesName = std::string(dir) + "/signatures_" + suffix + ext;
+            sightings.push_back(readFile(sightingsName));
+            signatures.push_back(readFile(signaturesName));
+            std::remove(sightingsName.c_str());
+            std::remove(signaturesName.c_str());
+        }
+        EXPECT_FALSE(sightings[0].empty());
+        EXPECT_FALSE(signatures[0].empty());
+        for (size_t i = 1; i < sightings.size(); i++) {
+            EXPECT_TRUE(sightings[i] == sightings[0]) << format << " run " << i;
+            EXPECT_TRUE(signatures[i] == signatures[0]) << format << " run " << i;
+        }
+    }
+    EXPECT_EQ(::rmdir(dir), 0);
+}
+
+// Test Case: A --threads value that is not a plain count prints the usage and fails without writing files
+TEST(CreateDatasetTest, BadThreadCount) {
+    char dir[] = "/tmp/test_create_dataset.XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    for (std::string threads : {"abc", "-4", "+2", "2x", "", "99999999999"}) {
+        EXPECT_EQ(runCreateDataset(dir, "100 10 bad 7 --binary --threads=" + threads), 1) << threads;
+        EXPECT_TRUE(readFile(std::string(dir) + "/sightings_bad.bin").empty()) << threads;
+    }
+    EXPECT_EQ(::rmdir(dir), 0);
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
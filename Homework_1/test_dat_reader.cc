@@ -0,0 +1,141 @@
+#include "dat_reader.h"
+#include <climits>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Helper: every int IntScanner reads out of @text before it stops
+static std::vector<int> scanAll(const std::string &text) {
+    IntScanner scanner(text.data(), text.data() + text.size());
+    std::vector<int> values;
+    int value;
+    while (scanner.Next(value)) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+// Test Case: Signs, every kind of whitespace and a last token without a newline
+TEST(IntScannerTest, WellFormed) {
+    EXPECT_EQ(scanAll(""), std::vector<int>());
+    EXPECT_EQ(scanAll(" \n\t "), std::vector<int>());
+    EXPECT_EQ(scanAll("31 -8\n28\t+11\r\n\v\f-0 7"), std::vector<int>({31, -8, 28, 11, 0, 7}));
+    EXPECT_EQ(scanAll("007 -007"), std::vector<int>({7, -7}));
+}
+
+// Test Case: The limits of int are read, one past them stops the scan
+TEST(IntScannerTest, Limits) {
+    EXPECT_EQ(scanAll("2147483647 -2147483648"), std::vector<int>({INT_MAX, INT_MIN}));
+    EXPECT_EQ(scanAll("1 2147483648 2"), std::vector<int>({1}));
+    EXPECT_EQ(scanAll("1 -2147483649 2"), std::vector<int>({1}));
+    EXPECT_EQ(scanAll("99999999999999999999"), std::vector<int>());
+}
+
+// Test Case: Like `stream >> int`, a bad token ends the scan, keeping a numeric prefix
+TEST(IntScannerTest, Malformed) {
+    EXPECT_EQ(scanAll("5 abc 6"), std::vector<int>({5}));
+    EXPECT_EQ(scanAll("5 - 6"), std::vector<int>({5}));
+    EXPECT_EQ(scanAll("5 --6"), std::vector<int>({5}));
+    EXPECT_EQ(scanAll("28 -11abc 20"), std::vector<int>({28, -11}));
+    EXPECT_EQ(scanAll("1.5 2"), std::vector<int>({1}));
+    EXPECT_EQ(scanAll(std::string("4\0 5", 4)), std::vector<int>({4}));
+}
+
+// Test Case: DatFile maps a regular file and reports a missing one
+TEST(DatFileTest, OpenAndMap) {
+    char path[] = "/tmp/test_dat_reader.XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    std::string text = "1 2\n3 4\n";
+    ASSERT_EQ(::write(fd, text.data(), text.size()), static_cast<ssize_t>(text.size()));
+    ::close(fd);
+    DatFile file;
+    ASSERT_TRUE(file.Open(path));
+    EXPECT_EQ(std::string(file.Begin(), file.End()), text);
+    ::unlink(path);
+    EXPECT_FALSE(file.Open("/nonexistent/file.dat"));
+    EXPECT_EQ(file.Length(), 0);
+}
+
+// Helper: every int IntStream reads out of @text written to a pipe in pieces of @piece bytes, and whether it failed
+static std::vector<int> streamAll(const std::string &text, size_t piece, bool &failed) {
+    int fds[2];
+    EXPECT_EQ(::pipe(fds), 0);
+    IntStream stream(fds[0]);
+    std::vector<int> values;
+    int value;
+    for (size_t done = 0; done < text.size(); done += piece) {
+        size_t n = std::min(piece, text.size() - done);
+        EXPECT_EQ(::write(fds[1], text.data() + done, n), static_cast<ssize_t>(n));
+        stream.Fill(-1);
+        while (stream.Next(value)) {
+            values.push_back(value);
+        }
+    }
+    ::close(fds[1]);
+    while (!stream.Done()) {
+        stream.Fill(-1);
+        while (stream.Next(value)) {
+            values.push_back(value);
+        }
+    }
+    ::close(fds[0]);
+    failed = stream.Failed();
+    return values;
+}
+
+// Test Case: Tokens split across reads are only handed out once complete
+TEST(IntStreamTest, SplitTokens) {
+    bool failed = true;
+    std::string text = "31 -8\n28 -11\n2147483647 -2147483648\n20 -8";
+    std::vector<int> expected = {31, -8, 28, -11, INT_MAX, INT_MIN, 20, -8};
+    for (size_t piece : {1, 2, 3, 7, 1000}) {
+        EXPECT_EQ(streamAll(text, piece, failed), expected) << "piece " << piece;
+        EXPECT_FALSE(failed);
+    }
+    EXPECT_EQ(streamAll("", 1, failed), std::vector<int>());
+    EXPECT_FALSE(failed);
+}
+
+// Test Case: A bad token ends the stream exactly where IntScanner stops
+TEST(IntStreamTest, Malformed) {
+    bool failed = false;
+    for (size_t piece : {1, 4, 1000}) {
+        std::string text = "31 -8\n28 -11abc\n20 -8\n";
+        EXPECT_EQ(streamAll(text, piece, failed), scanAll(text)) << "piece " << piece;
+        EXPECT_TRUE(failed);
+        EXPECT_EQ(streamAll("1 2147483648 2", piece, failed), std::vector<int>({1}));
+        EXPECT_TRUE(failed);
+        EXPECT_EQ(streamAll("1 x", piece, failed), std::vector<int>({1}));
+        EXPECT_TRUE(failed);
+        EXPECT_EQ(streamAll(std::string("\x01\x00\x00\x00", 4), piece, failed), std::vector<int>());
+        EXPECT_TRUE(failed);
+    }
+}
+
+// Test Case: A read error fails the stream instead of looking like a clean end
+TEST(IntStreamTest, ReadError) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ::close(fds[1]);
+    ::close(fds[0]);
+    // A closed fd, waited on or not, and an invalid one
+    std::vector<std::pair<int, int>> cases = {{fds[0], -1}, {fds[0], 0}, {-1, -1}};
+    for (const auto &fdTimeout : cases) {
+        IntStream stream(fdTimeout.first);
+        int value;
+        EXPECT_FALSE(stream.Fill(fdTimeout.second));
+        EXPECT_FALSE(stream.Next(value));
+        EXPECT_TRUE(stream.Failed());
+        EXPECT_TRUE(stream.Done());
+        EXPECT_FALSE(stream.Fill(-1));
+    }
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
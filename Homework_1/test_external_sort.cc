@@ -0,0 +1,88 @@
+#include "external_sort.h"
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <vector>
+#include <sys/resource.h>
+#include <gtest/gtest.h>
+
+// Helper: sort @values with an ExternalSorter of @budget bytes, return what it hands back
+static std::vector<int> externalSort(const std::vector<int> &values, size_t budget, bool unique, bool &ok) {
+    ExternalSorter sorter(budget, "/tmp", unique);
+    ok = true;
+    for (auto v : values) {
+        ok = ok && sorter.Add(v);
+    }
+    ok = ok && sorter.Finish();
+    std::vector<int> out;
+    int value;
+    while (sorter.Next(value)) {
+        out.push_back(value);
+    }
+    ok = ok && sorter.Ok();
+    return out;
+}
+
+// Helper: @count random values, some repeated, the int limits included
+static std::vector<int> randomValues(size_t count, unsigned seed) {
+    std::mt19937 mt(seed);
+    std::vector<int> values(count);
+    for (auto &v : values) {
+        v = static_cast<int>(mt()) % 200000;
+    }
+    if (count >= 2) {
+        values[0] = INT_MIN;
+        values[count / 2] = INT_MAX;
+    }
+    return values;
+}
+
+// Test Case: Input that fits in the budget is sorted in memory
+TEST(ExternalSorterTest, InMemory) {
+    bool ok = false;
+    std::vector<int> values = randomValues(1000, 1);
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(externalSort(values, 1 << 20, false, ok), expected);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(externalSort({}, 1 << 20, false, ok), std::vector<int>());
+    EXPECT_TRUE(ok);
+}
+
+// Test Case: Many more runs than FanIn() at the smallest budget, with and without duplicates
+TEST(ExternalSorterTest, ManyRuns) {
+    bool ok = false;
+    // 8K values per run at the smallest budget, FanIn() is 3: about 120 runs, merged over several tiers
+    std::vector<int> values = randomValues(1000000, 2);
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(externalSort(values, ExternalSorter::kMinBudget, false, ok), expected);
+    EXPECT_TRUE(ok);
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    EXPECT_EQ(externalSort(values, ExternalSorter::kMinBudget, true, ok), expected);
+    EXPECT_TRUE(ok);
+}
+
+// Test Case: More runs than the process may have open files: the open runs must stay bounded
+TEST(ExternalSorterTest, MoreRunsThanFileLimit) {
+    struct rlimit saved;
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+    struct rlimit low = saved;
+    low.rlim_cur = 64;
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &low), 0);
+    bool ok = false;
+    // About 370 runs of 8K values, several times the 64 descriptors allowed
+    std::vector<int> values = randomValues(3000000, 3);
+    std::vector<int> sorted = externalSort(values, ExternalSorter::kMinBudget, true, ok);
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+    EXPECT_TRUE(ok);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    EXPECT_EQ(sorted, values);
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,88 @@
+#include "hash_set.h"
+#include <climits>
+#include <map>
+#include <random>
+#include <gtest/gtest.h>
+
+// Test Case: INT_MIN marks empty slots, so it is kept apart and must behave like any other key
+TEST(IntHashSetTest, EmptyMarkerKey) {
+    IntHashSet set;
+    EXPECT_FALSE(set.Contains(INT_MIN));
+    EXPECT_TRUE(set.Insert(INT_MIN));
+    EXPECT_FALSE(set.Insert(INT_MIN));
+    EXPECT_TRUE(set.Contains(INT_MIN));
+    EXPECT_EQ(set.Size(), 1);
+    EXPECT_TRUE(set.Insert(INT_MAX));
+    EXPECT_TRUE(set.Insert(0));
+    EXPECT_TRUE(set.Insert(-1));
+    EXPECT_EQ(set.Size(), 4);
+    EXPECT_FALSE(set.Contains(INT_MIN + 1));
+    set.Clear();
+    EXPECT_TRUE(set.Empty());
+    EXPECT_FALSE(set.Contains(INT_MIN));
+    EXPECT_FALSE(set.Contains(INT_MAX));
+}
+
+// Test Case: Keys survive many rehashes and duplicates are rejected
+TEST(IntHashSetTest, GrowthAndDuplicates) {
+    IntHashSet set(1);
+    std::mt19937 mt(7);
+    std::map<int, bool> expected;
+    for (int i = 0; i < 100000; i++) {
+        int key = static_cast<int>(mt()) % 50000;
+        bool added = expected.insert(std::make_pair(key, true)).second;
+        EXPECT_EQ(set.Insert(key), added);
+    }
+    EXPECT_EQ(set.Size(), expected.size());
+    for (int key = -50000; key < 50000; key++) {
+        ASSERT_EQ(set.Contains(key), expected.count(key) == 1) << "key " << key;
+    }
+}
+
+// Test Case: Counts, including INT_MIN, are reported by Count and ForEach
+TEST(IntCountTableTest, CountsAndForEach) {
+    IntCountTable table(2);
+    std::map<int, uint64_t> expected;
+    std::mt19937 mt(11);
+    for (int i = 0; i < 50000; i++) {
+        int key = i % 7 == 0 ? INT_MIN : static_cast<int>(mt() % 1000) - 500;
+        table.Add(key);
+        expected[key]++;
+    }
+    table.Add(INT_MAX);
+    expected[INT_MAX]++;
+    EXPECT_EQ(table.Size(), expected.size());
+    for (const auto &entry : expected) {
+        EXPECT_EQ(table.Count(entry.first), entry.second) << "key " << entry.first;
+    }
+    EXPECT_EQ(table.Count(INT_MIN + 1), 0);
+    std::map<int, uint64_t> visited;
+    table.ForEach([&](int key, uint64_t count) {
+        EXPECT_EQ(visited.count(key), 0);
+        visited[key] = count;
+    });
+    EXPECT_EQ(visited, expected);
+}
+
+// Test Case: A table that only ever saw INT_MIN
+TEST(IntCountTableTest, OnlyEmptyMarkerKey) {
+    IntCountTable table;
+    EXPECT_EQ(table.Size(), 0);
+    table.Add(INT_MIN);
+    table.Add(INT_MIN);
+    EXPECT_EQ(table.Size(), 1);
+    EXPECT_EQ(table.Count(INT_MIN), 2);
+    int calls = 0;
+    table.ForEach([&](int key, uint64_t count) {
+        EXPECT_EQ(key, INT_MIN);
+        EXPECT_EQ(count, 2);
+        calls++;
+    });
+    EXPECT_EQ(calls, 1);
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,94 @@
+#include "dataset_generator.h"
+#include "sighting_search.h"
+#include <random>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Helper: sighting signatures (duplicates kept) and signatures of a create_dataset style dataset
+static void generate(int nsights, int nsigs, unsigned seed, std::vector<int> &records, std::vector<int> &signatures) {
+    std::mt19937 mt(seed);
+    records.clear();
+    signatures.clear();
+    generateDataset(nsights, nsigs, mt,
+                    [&](int s, int b) { records.push_back(sightingSignature(s, b)); },
+                    [&](int s) { signatures.push_back(s); });
+}
+
+// Helper: the exact count, signatures whose value is among the sightings
+static int exactCount(const std::vector<int> &records, const std::vector<int> &signatures) {
+    std::set<int> seen(records.begin(), records.end());
+    int count = 0;
+    for (auto s : signatures) {
+        count += seen.count(s) ? 1 : 0;
+    }
+    return count;
+}
+
+// Helper: estimate from blocks of both sides sampled at @rate, the way --approx reads a binary dataset
+static MatchEstimate estimate(const std::vector<int> &records, const std::vector<int> &signatures, double rate,
+                              uint32_t seed) {
+    MatchEstimator estimator;
+    double signatureFraction = forEachSampledRecord(signatures.data(), signatures.size(), rate, seed,
+                                                    [&](int v) { estimator.AddSignature(v); });
+    double sightingFraction = forEachSampledRecord(records.data(), records.size(), rate, seed + 1,
+                                                   [&](int v) { estimator.AddSighting(v); });
+    return estimator.Estimate(sightingFraction, signatureFraction, 0.95);
+}
+
+// Test Case: Reading everything gives the exact count with an interval of zero width
+TEST(MatchEstimateTest, FullSampleIsExact) {
+    std::vector<int> records, signatures;
+    generate(50000, 20000, 3, records, signatures);
+    double exact = exactCount(records, signatures);
+    MatchEstimate full = estimate(records, signatures, 1.0, 5);
+    EXPECT_EQ(full.count, exact);
+    EXPECT_EQ(full.low, exact);
+    EXPECT_EQ(full.high, exact);
+    EXPECT_EQ(full.sightingFraction, 1);
+    EXPECT_EQ(full.signatureFraction, 1);
+}
+
+// Test Case: With fixed seeds, the interval of every sampled estimate holds the exact count
+TEST(MatchEstimateTest, IntervalHoldsExactCount) {
+    std::vector<int> records, signatures;
+    generate(2000000, 500000, 42, records, signatures);
+    double exact = exactCount(records, signatures);
+    for (double rate : {0.01, 0.05, 0.2}) {
+        for (uint32_t seed = 1; seed <= 5; seed++) {
+            MatchEstimate e = estimate(records, signatures, rate, 2 * seed);
+            EXPECT_LE(e.low, exact) << "rate " << rate << " seed " << seed;
+            EXPECT_GE(e.high, exact) << "rate " << rate << " seed " << seed;
+            EXPECT_LE(e.low, e.count);
+            EXPECT_LE(e.count, e.high);
+            EXPECT_GT(e.sightingFraction, 0);
+            EXPECT_LE(e.sightingFraction, 1);
+        }
+    }
+}
+
+// Test Case: Sightings that are all distinct (no repeats for Chao1) still get an interval holding the count
+TEST(MatchEstimateTest, DistinctSightings) {
+    std::vector<int> records(200000), signatures;
+    for (size_t i = 0; i < records.size(); i++) {
+        records[i] = static_cast<int>(3 * i);
+    }
+    std::mt19937 mt(9);
+    std::shuffle(records.begin(), records.end(), mt);
+    std::uniform_int_distribution<int> value(0, 1200000);
+    for (int i = 0; i < 100000; i++) {
+        signatures.push_back(value(mt));
+    }
+    double exact = exactCount(records, signatures);
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        MatchEstimate e = estimate(records, signatures, 0.1, 2 * seed);
+        EXPECT_LE(e.low, exact) << "seed " << seed;
+        EXPECT_GE(e.high, exact) << "seed " << seed;
+    }
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+#include "dataset_generator.h"
+#include "sighting_search.h"
+#include <climits>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Helper: the count every engine must return, straight from the definition
+static int referenceCount(const std::vector<int> &sightings, const std::vector<int> &signatures) {
+    std::set<int> seen(sightings.begin(), sightings.end());
+    int count = 0;
+    for (auto s : signatures) {
+        count += seen.count(s) ? 1 : 0;
+    }
+    return count;
+}
+
+// Helper: run every engine, serial and on @pool, on copies of the inputs and compare with the reference
+static void expectAllEnginesAgree(const std::vector<int> &sightings, const std::vector<int> &signatures,
+                                  ThreadPool &pool, const std::string &label) {
+    int expected = referenceCount(sightings, signatures);
+    std::vector<int> sorted = sightings;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (int level = kSimdScalar; level <= kSimdAvx512; level++) {
+        LinearKernel kernel = linearKernel(static_cast<SimdLevel>(level));
+        EXPECT_EQ(simdLinearSearch(sightings, signatures, kernel), expected) << label << " simd level " << level;
+        EXPECT_EQ(parallelLinearSearch(sightings, signatures, pool, kernel), expected) << label << " level " << level;
+    }
+    EXPECT_EQ(linearsearch(sightings, signatures), expected) << label;
+    EXPECT_EQ(binSearch(sorted, signatures), expected) << label;
+    EXPECT_EQ(eytzingerSearch(sorted, signatures), expected) << label;
+    EXPECT_EQ(packedSearch(sorted, signatures), expected) << label;
+    EXPECT_EQ(parallelBinSearch(sorted, signatures, pool), expected) << label;
+    EXPECT_EQ(parallelEytzingerSearch(sorted, signatures, pool), expected) << label;
+    EXPECT_EQ(parallelPackedSearch(sorted, signatures, pool), expected) << label;
+    if (SignatureBitmap::Suits(sightings)) {
+        EXPECT_EQ(bitmapSearch(sightings, signatures), expected) << label;
+        EXPECT_EQ(parallelBitmapSearch(sightings, signatures, pool), expected) << label;
+    }
+    {
+        std::vector<int> a = sightings, b = signatures;
+        EXPECT_EQ(radixJoinSearch(a, b), expected) << label;
+    }
+    {
+        std::vector<int> a = sightings, b = signatures;
+        EXPECT_EQ(parallelRadixJoinSearch(a, b, pool), expected) << label;
+    }
+    for (const char *engine : {"binary", "eytzinger", "packed"}) {
+        PrefilterStats stats;
+        EXPECT_EQ(prefilteredSearch(sorted, signatures, engine, 0.01, nullptr, stats), expected) << label << engine;
+        EXPECT_EQ(prefilteredSearch(sorted, signatures, engine, 0.01, &pool, stats), expected) << label << engine;
+    }
+}
+
+// Test Case: Every engine finds the same matches on create_dataset data
+TEST(SearchEnginesTest, GeneratedDatasets) {
+    ThreadPool pool(3);
+    for (int seed : {0, 1, 2}) {
+        for (int nsights : {10, 1000, 20000}) {
+            std::mt19937 mt(seed);
+            std::vector<int> sightings, signatures;
+            IntHashSet seen(nsights);
+            generateDataset(nsights, 5000, mt,
+                [&](int s, int b) {
+                    int signature = sightingSignature(s, b);
+                    if (seen.Insert(signature)) {
+                        sightings.push_back(signature);
+                    }
+                },
+                [&](int s) { signatures.push_back(s); });
+            expectAllEnginesAgree(sightings, signatures, pool,
+                                  "seed " + std::to_string(seed) + " sightings " + std::to_string(nsights));
+        }
+    }
+}
+
+// Test Case: No sightings, signatures all above or below the sightings, and the int limits
+TEST(SearchEnginesTest, EdgeCases) {
+    ThreadPool pool(4);
+    expectAllEnginesAgree({}, {1, 2, 3}, pool, "no sightings");
+    expectAllEnginesAgree({1, 2, 3}, {}, pool, "no signatures");
+    expectAllEnginesAgree({1, 2}, {100000, 200000, 300000, 400000}, pool, "signatures above");
+    expectAllEnginesAgree({100000, 200000}, {1, 2, 3, 4, 5}, pool, "signatures below");
+    expectAllEnginesAgree({INT_MIN, -1, 0, INT_MAX}, {INT_MAX, INT_MIN, INT_MIN, 5, 0, 0, -1}, pool, "limits");
+    std::vector<int> repeated(1000, 7);
+    repeated.push_back(8);
+    expectAllEnginesAgree({7, 9}, repeated, pool, "repeated signature");
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,37 @@
+#include "sighting_search.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Test Case: --threads takes a plain count (0 for one per hardware thread) up to a sane limit
+TEST(SearchOptionsTest, Threads) {
+    SearchOptions options;
+    EXPECT_TRUE(parseSearchOption("--threads=4", options));
+    EXPECT_EQ(options.threads, 4);
+    EXPECT_TRUE(parseSearchOption("--threads=0", options));
+    EXPECT_EQ(options.threads, 0);
+    unsigned limit = 4 * std::max(1u, std::thread::hardware_concurrency());
+    EXPECT_TRUE(parseSearchOption("--threads=" + std::to_string(limit), options));
+    EXPECT_EQ(options.threads, limit);
+}
+
+// Test Case: Negative, signed, non-numeric, oversized or missing --threads values are rejected
+TEST(SearchOptionsTest, ThreadsRejected) {
+    SearchOptions options;
+    options.threads = 3;
+    unsigned limit = 4 * std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> values = {"-1", "-0", "+2", "abc", "4x", " 4", "", "4294967297", "99999999999999999999",
+                                       std::to_string(limit + 1)};
+    for (const std::string &value : values) {
+        EXPECT_FALSE(parseSearchOption("--threads=" + value, options)) << "value '" << value << "'";
+    }
+    EXPECT_FALSE(parseSearchOption("--threads", options));
+    EXPECT_EQ(options.threads, 3);
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+#include "sighting_search.h"
+#include <climits>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+// Helper: check every count of @catalog against the multiset @reference
+static void expectSameCounts(const SignatureCatalog &catalog, const std::map<int, uint64_t> &reference) {
+    uint64_t total = 0;
+    for (const auto &entry : reference) {
+        EXPECT_EQ(catalog.Count(entry.first), entry.second) << "value " << entry.first;
+        total += entry.second;
+    }
+    EXPECT_EQ(catalog.Size(), total);
+}
+
+// Helper: file descriptor of an unlinked temporary file holding @text, positioned at its start
+static int textFd(const std::string &text) {
+    char name[] = "/tmp/test_signature_catalog.XXXXXX";
+    int fd = ::mkstemp(name);
+    EXPECT_GE(fd, 0);
+    ::unlink(name);
+    EXPECT_EQ(::write(fd, text.data(), text.size()), static_cast<ssize_t>(text.size()));
+    ::lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+// Helper: streamSightings on @sightings with catalog updates @updates, for the 'l'inear or 'b'inary matcher
+static int streamWithUpdates(const std::vector<int> &signatures, char strategy, const std::string &sightings,
+                             const std::string &updates) {
+    StreamMatcher matcher(signatures, strategy);
+    std::ostringstream out;
+    int fd = textFd(sightings);
+    int updatesFd = textFd(updates);
+    int match = streamSightings(fd, matcher, 0, 0, out, updatesFd);
+    ::close(fd);
+    ::close(updatesFd);
+    return match;
+}
+
+// Test Case: Counts follow inserts and retirements, and retiring more than there are retires them all
+TEST(SignatureCatalogTest, InsertAndRetire) {
+    SignatureCatalog catalog({5, -3, 5, 7, 5, INT_MIN, INT_MAX});
+    std::map<int, uint64_t> reference = {{5, 3}, {-3, 1}, {7, 1}, {INT_MIN, 1}, {INT_MAX, 1}};
+    expectSameCounts(catalog, reference);
+    EXPECT_EQ(catalog.Count(6), 0);
+
+    catalog.Add(6, 2);
+    catalog.Add(5);
+    reference[6] = 2;
+    reference[5] = 4;
+    expectSameCounts(catalog, reference);
+
+    EXPECT_EQ(catalog.Remove(5, 3), 3);
+    EXPECT_EQ(catalog.Remove(-3, 10), 1);
+    EXPECT_EQ(catalog.Remove(42), 0);
+    EXPECT_EQ(catalog.Remove(INT_MIN), 1);
+    reference[5] = 1;
+    reference[-3] = 0;
+    reference[INT_MIN] = 0;
+    expectSameCounts(catalog, reference);
+
+    // Retired then added again
+    catalog.Add(-3);
+    reference[-3] = 1;
+    expectSameCounts(catalog, reference);
+}
+
+// Test Case: Enough changes merge into the sorted array without changing any count
+TEST(SignatureCatalogTest, Compaction) {
+    std::mt19937 mt(17);
+    std::uniform_int_distribution<int> value(-2000, 2000);
+    std::vector<int> signatures(8192);
+    std::map<int, uint64_t> reference;
+    for (auto &s : signatures) {
+        s = value(mt);
+        reference[s]++;
+    }
+    SignatureCatalog catalog(signatures);
+    EXPECT_EQ(catalog.Pending(), 0);
+    size_t compactions = 0;
+    for (int i = 0; i < 20000; i++) {
+        int v = value(mt);
+        size_t pending = catalog.Pending();
+        if (mt() % 3 == 0) {
+            uint64_t removed = catalog.Remove(v, mt() % 4);
+            EXPECT_LE(removed, reference[v]);
+            reference[v] -= removed;
+        } else {
+            uint64_t times = 1 + mt() % 3;
+            catalog.Add(v, times);
+            reference[v] += times;
+        }
+        compactions += catalog.Pending() < pending;
+        ASSERT_LE(catalog.Pending(), std::max<size_t>(SignatureCatalog::kMinChanges, reference.size() / 16) + 1);
+    }
+    EXPECT_GT(compactions, 0);
+    expectSameCounts(catalog, reference);
+    catalog.Compact();
+    EXPECT_EQ(catalog.Pending(), 0);
+    expectSameCounts(catalog, reference);
+}
+
+// Test Case: UpdateSignature keeps the linear and binary matchers at the batch count of the current catalog
+TEST(StreamMatcherTest, UpdateSignature) {
+    std::mt19937 mt(23);
+    std::uniform_int_distribution<int> value(-300, 300);
+    std::vector<int> signatures(1000);
+    for (auto &s : signatures) {
+        s = value(mt);
+    }
+    std::map<int, int> catalog;
+    for (auto s : signatures) {
+        catalog[s]++;
+    }
+    StreamMatcher linear(signatures, 'l'), binary(signatures, 'b');
+    std::set<int> seen;
+    for (int i = 0; i < 5000; i++) {
+        int v = value(mt);
+        if (mt() % 2) {
+            seen.insert(v);
+            linear.Add(v);
+            binary.Add(v);
+        } else {
+            // Retirements of absent signatures and of more than there are included
+            int times = static_cast<int>(mt() % 7) - 3;
+            if (times == 0) {
+                times = 1;
+            }
+            catalog[v] = std::max(0, catalog[v] + times);
+            linear.UpdateSignature(v, times);
+            binary.UpdateSignature(v, times);
+        }
+        int expected = 0;
+        for (auto s : seen) {
+            expected += catalog[s];
+        }
+        ASSERT_EQ(linear.Matches(), expected) << "step " << i;
+        ASSERT_EQ(binary.Matches(), expected) << "step " << i;
+    }
+}
+
+// Test Case: streamSightings applies --updates pairs and fails on a bad or truncated update stream
+TEST(StreamSightingsTest, Updates) {
+    std::vector<int> signatures = {3, 3, 8, -4};
+    // Sighting signatures 3 (6 * 5), 8 (8 * 10) and -4 (-7 * 6): 4 matches before any update
+    std::string sightings = "6 5\n8 10\n-7 6\n6 5\n";
+    for (char strategy : {'l', 'b'}) {
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, ""), 4);
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, "3 8\n-1 3\n5 100\n-9 -4\n"), 5);
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, "1 8\n-1 3"), 4);
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, "1 8\n-1 x\n"), -1);
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, "1 8\n-1"), -1);
+        EXPECT_EQ(streamWithUpdates(signatures, strategy, sightings, "1 8 2147483648 3\n"), -1);
+    }
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+#include "signature_kernel.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Helper: the definition of a signature, ceil(speed * brightness / 10) in doubles, when it fits in an int
+static bool doubleSignature(int speed, int brightness, int &signature) {
+    double value = std::ceil(static_cast<double>(speed) * static_cast<double>(brightness) / 10);
+    if (value < INT_MIN || value > INT_MAX) {
+        return false;
+    }
+    signature = static_cast<int>(value);
+    return true;
+}
+
+// Helper: run the kernel of every level the CPU supports (scalar included) on the first @n records and
+// compare each signature with sightingSignature
+static void expectKernelsMatch(const std::vector<int> &speeds, const std::vector<int> &brightnesses, size_t n) {
+    for (int level = kSimdScalar; level <= supportedSimdLevel(); level++) {
+        SignatureKernel kernel = signatureKernel(static_cast<SimdLevel>(level));
+        // One extra slot checks that the kernel stops at @n
+        std::vector<int> signatures(n + 1, 0x5eed);
+        kernel(speeds.data(), brightnesses.data(), signatures.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(signatures[i], sightingSignature(speeds[i], brightnesses[i]))
+                << "level " << level << " n " << n << " speed " << speeds[i] << " brightness " << brightnesses[i];
+        }
+        EXPECT_EQ(signatures[n], 0x5eed) << "level " << level << " n " << n;
+    }
+}
+
+// Values around zero, the rounding of the division, the 16-bit range the vector path handles and INT_MIN/INT_MAX
+static const std::vector<int> kEdgeValues = {0, 1, -1, 9, 10, 11, -9, -10, -11, 99, -101, 46340, -46341,
+                                             32766, 32767, 32768, 32769, -32767, -32768, -32769, -32770,
+                                             65535, 65536, -65536, INT_MAX, INT_MAX - 1, INT_MIN, INT_MIN + 1};
+
+// Test Case: sightingSignature is the double ceil formula wherever that fits in an int
+TEST(SignatureKernelTest, IntegerFormulaMatchesDoubleCeil) {
+    for (int speed : kEdgeValues) {
+        for (int brightness : kEdgeValues) {
+            int expected;
+            if (doubleSignature(speed, brightness, expected)) {
+                EXPECT_EQ(sightingSignature(speed, brightness), expected) << speed << " * " << brightness;
+            }
+        }
+    }
+    std::mt19937 mt(2024);
+    std::uniform_int_distribution<int> any(INT_MIN, INT_MAX);
+    std::uniform_int_distribution<int> narrow(-40000, 40000);
+    for (int i = 0; i < 200000; i++) {
+        int speed = i % 2 ? any(mt) : narrow(mt);
+        int brightness = narrow(mt);
+        int expected;
+        if (doubleSignature(speed, brightness, expected)) {
+            ASSERT_EQ(sightingSignature(speed, brightness), expected) << speed << " * " << brightness;
+        }
+    }
+}
+
+// Test Case: Every edge pair, with wide values mixed into vectors of narrow ones, and every tail length
+TEST(SignatureKernelTest, EdgeValues) {
+    std::vector<int> speeds, brightnesses;
+    for (int speed : kEdgeValues) {
+        for (int brightness : kEdgeValues) {
+            speeds.push_back(speed);
+            brightnesses.push_back(brightness);
+        }
+    }
+    std::mt19937 mt(7);
+    std::shuffle(speeds.begin(), speeds.end(), mt);
+    std::shuffle(brightnesses.begin(), brightnesses.end(), mt);
+    for (size_t n = 0; n <= 40; n++) {
+        expectKernelsMatch(speeds, brightnesses, n);
+    }
+    expectKernelsMatch(speeds, brightnesses, speeds.size());
+}
+
+// Test Case: Blocks that stay inside the 16-bit range up to its boundaries, and ones that just leave it
+TEST(SignatureKernelTest, SixteenBitBoundary) {
+    std::mt19937 mt(11);
+    std::uniform_int_distribution<int> narrow(-32768, 32767);
+    std::vector<int> speeds(4096), brightnesses(4096);
+    for (size_t i = 0; i < speeds.size(); i++) {
+        speeds[i] = narrow(mt);
+        brightnesses[i] = narrow(mt);
+    }
+    // Every extreme the vector path still takes, in every lane
+    for (size_t i = 0; i < 64; i++) {
+        speeds[i] = i % 2 ? 32767 : -32768;
+        brightnesses[i] = i % 4 < 2 ? -32768 : 32767;
+    }
+    expectKernelsMatch(speeds, brightnesses, speeds.size());
+    // One value just outside the range sends its block to the scalar fallback, in each lane position
+    for (int wide : {32768, -32769, INT_MAX, INT_MIN}) {
+        for (size_t lane = 0; lane < 16; lane++) {
+            std::vector<int> s = speeds, b = brightnesses;
+            (lane % 2 ? s : b)[128 + lane] = wide;
+            expectKernelsMatch(s, b, s.size());
+        }
+    }
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
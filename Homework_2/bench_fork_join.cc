@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "deque.h"
+#include "fork_join_pool.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+Name        : isPrime
+Description : Trial division, so the cost of an item grows with its value and jumps between items
+Receives    : the number
+Returns     : true if @n is prime.
+*/
+bool isPrime(size_t n)
+{
+    if (n < 2)
+        return false;
+    for (size_t d = 2; d * d <= n; d++)
+    {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+
+/*
+Name        : countPrimes
+Description : Number of primes among the items [begin, end) of the workload; item i is the number i, except
+              that the last eighth of the items are @skew times bigger, so most of the work is at the end
+Receives    : the range, the skew
+Returns     : Number of primes.
+*/
+long long countPrimes(size_t begin, size_t end, size_t n, size_t skew)
+{
+    long long count = 0;
+    for (size_t i = begin; i < end; i++)
+        count += isPrime(i < n - n / 8 ? i : i * skew + 1);
+    return count;
+}
+
+// One contiguous chunk per thread, as a pool with a fixed split hands out
+long long staticSplit(size_t n, size_t skew, unsigned threads)
+{
+    std::vector<long long> counts(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&, t] { counts[t] = countPrimes(n * t / threads, n * (t + 1) / threads, n, skew); });
+    for (auto &worker : workers)
+        worker.join();
+    long long total = 0;
+    for (auto c : counts)
+        total += c;
+    return total;
+}
+
+// Chunks of @grain items in one Deque behind a mutex that every thread takes from
+long long sharedQueue(size_t n, size_t skew, unsigned threads, size_t grain)
+{
+    Deque<std::pair<size_t, size_t>> chunks;
+    for (size_t begin = 0; begin < n; begin += grain)
+        chunks.PushBack(std::make_pair(begin, std::min(n, begin + grain)));
+    std::mutex lock;
+    std::atomic<long long> total(0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&] {
+            while (true)
+            {
+                std::pair<size_t, size_t> chunk;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (chunks.Empty())
+                        return;
+                    chunk = chunks.Front();
+                    chunks.PopFront();
+                }
+                total += countPrimes(chunk.first, chunk.second, n, skew);
+            }
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    return total;
+}
+
+// Recursive halving on the work-stealing pool
+long long forkJoin(ForkJoinPool &pool, size_t n, size_t skew, size_t grain)
+{
+    std::atomic<long long> total(0);
+    pool.ParallelFor(n, grain, [&](size_t begin, size_t end) { total += countPrimes(begin, end, n, skew); });
+    return total;
+}
+
+void report(const std::string &name, size_t n, unsigned threads, size_t grain, const std::function<long long()> &run)
+{
+    auto start = Clock::now();
+    long long primes = run();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << name << "," << n << "," << threads << "," << grain << "," << primes << "," << ms << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t n = 1000000;
+    size_t skew = 64;
+    size_t grain = 1024;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        std::string value = option.substr(option.find('=') + 1);
+        long long number = std::atoll(value.c_str());
+        if (option.find('=') == std::string::npos || number <= 0)
+        {
+            std::cerr << "Usage: " << argv[0] << " [--items=N] [--skew=N] [--grain=N] [--threads=N]" << std::endl;
+            return 1;
+        }
+        if (option.compare(0, 8, "--items=") == 0)
+            n = number;
+        else if (option.compare(0, 7, "--skew=") == 0)
+            skew = number;
+        else if (option.compare(0, 8, "--grain=") == 0)
+            grain = number;
+        else if (option.compare(0, 10, "--threads=") == 0)
+            threads = number;
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "scheduler,items,threads,grain,primes,ms" << std::endl;
+    report("static_split", n, threads, n / threads, [&] { return staticSplit(n, skew, threads); });
+    report("shared_queue", n, threads, grain, [&] { return sharedQueue(n, skew, threads, grain); });
+    ForkJoinPool pool(threads);
+    report("fork_join", n, threads, grain, [&] { return forkJoin(pool, n, skew, grain); });
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "deque.h"
+#include "spsc_ring.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// The baseline: a Deque behind a mutex, bounded to the same capacity as the ring
+template <typename T>
+class MutexQueue
+{
+public:
+    explicit MutexQueue(size_t capacity) : capacity(capacity) {}
+
+    size_t PushBatch(const T *items, size_t count)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t n = std::min(count, capacity - queue.Size());
+        queue.PushBackRange(items, n);
+        return n;
+    }
+
+    size_t PopBatch(T *out, size_t count)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t n = std::min(count, queue.Size());
+        queue.CopyOut(0, n, out);
+        queue.PopFrontN(n);
+        return n;
+    }
+
+private:
+    std::mutex lock;
+    Deque<T> queue;
+    size_t capacity;
+};
+
+/*
+Name        : sendAll
+Description : Pushes @items through @queue in batches of @batch, yielding while it is full
+Receives    : the queue, the items, batch size
+Returns     : nothing.
+*/
+template <typename Queue, typename T>
+void sendAll(Queue &queue, const std::vector<T> &items, size_t batch)
+{
+    for (size_t done = 0; done < items.size();)
+    {
+        size_t n = queue.PushBatch(items.data() + done, std::min(batch, items.size() - done));
+        done += n;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+}
+
+/*
+Name        : receiveAll
+Description : Pops @count items from @queue in batches of @batch, yielding while it is empty
+Receives    : the queue, number of items, batch size, callback for every item
+Returns     : nothing.
+*/
+template <typename Queue, typename T, typename Fn>
+void receiveAll(Queue &queue, size_t count, size_t batch, std::vector<T> &buffer, Fn fn)
+{
+    buffer.resize(batch);
+    for (size_t done = 0; done < count;)
+    {
+        size_t n = queue.PopBatch(buffer.data(), std::min(batch, count - done));
+        for (size_t i = 0; i < n; i++)
+            fn(buffer[i]);
+        done += n;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+}
+
+/*
+Name        : throughput
+Description : One producer thread sends @count ints to one consumer thread through @queue
+Receives    : the queue, number of items, batch size
+Returns     : Items per second; exits if the consumer got wrong data.
+*/
+template <typename Queue>
+double throughput(Queue &queue, size_t count, size_t batch)
+{
+    std::vector<long long> items(count);
+    for (size_t i = 0; i < count; i++)
+        items[i] = static_cast<long long>(i);
+    long long sum = 0;
+    std::vector<long long> buffer;
+    auto start = Clock::now();
+    std::thread consumer([&]() { receiveAll(queue, count, batch, buffer, [&](long long v) { sum += v; }); });
+    sendAll(queue, items, batch);
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (sum != static_cast<long long>(count) * (static_cast<long long>(count) - 1) / 2)
+    {
+        std::cerr << "Error: consumer received wrong items" << std::endl;
+        std::exit(1);
+    }
+    return count / seconds;
+}
+
+/*
+Name        : latency
+Description : Ping-pong of @rounds single items between two threads over a pair of queues; a round trip is two
+              hand-offs, so half of it is the latency of one
+Receives    : the two queues, number of round trips
+Returns     : Hand-off latencies in nanoseconds, sorted.
+*/
+template <typename Queue>
+std::vector<double> latency(Queue &ping, Queue &pong, size_t rounds)
+{
+    std::vector<double> times;
+    times.reserve(rounds);
+    std::thread echo([&]() {
+        long long v;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            while (ping.PopBatch(&v, 1) == 0)
+                std::this_thread::yield();
+            while (pong.PushBatch(&v, 1) == 0)
+                std::this_thread::yield();
+        }
+    });
+    for (size_t i = 0; i < rounds; i++)
+    {
+        long long v = static_cast<long long>(i);
+        auto start = Clock::now();
+        while (ping.PushBatch(&v, 1) == 0)
+            std::this_thread::yield();
+        while (pong.PopBatch(&v, 1) == 0)
+            std::this_thread::yield();
+        times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / 2);
+    }
+    echo.join();
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+template <typename Queue>
+void run(const std::string &name, size_t items, size_t capacity, size_t batch, size_t rounds)
+{
+    Queue queue(capacity);
+    double rate = throughput(queue, items, batch);
+    Queue ping(capacity), pong(capacity);
+    std::vector<double> times = latency(ping, pong, rounds);
+    std::cout << name << "," << items << "," << capacity << "," << batch << "," << rate << ","
+              << times[times.size() / 2] << "," << times[std::min(times.size() - 1, times.size() * 99 / 100)]
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t items = 10000000;
+    size_t capacity = 1024;
+    size_t batch = 1;
+    size_t rounds = 100000;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        std::string value = option.substr(option.find('=') + 1);
+        long long number = std::atoll(value.c_str());
+        if (option.find('=') == std::string::npos || number <= 0)
+        {
+            std::cerr << "Usage: " << argv[0] << " [--items=N] [--capacity=N] [--batch=N] [--rounds=N]" << std::endl;
+            return 1;
+        }
+        if (option.compare(0, 8, "--items=") == 0)
+            items = number;
+        else if (option.compare(0, 11, "--capacity=") == 0)
+            capacity = number;
+        else if (option.compare(0, 8, "--batch=") == 0)
+            batch = number;
+        else if (option.compare(0, 9, "--rounds=") == 0)
+            rounds = number;
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "queue,items,capacity,batch,items_per_sec,latency_median_ns,latency_p99_ns" << std::endl;
+    run<SpscRing<long long>>("spsc_ring", items, capacity, batch, rounds);
+    run<MutexQueue<long long>>("mutex_deque", items, capacity, batch, rounds);
+    return 0;
+}
@@ -1,29 +1,58 @@
 #ifndef DEQUE_H_
 #define DEQUE_H_
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 template <typename T>
 class Deque
 {
+    template <bool Const>
+    class Iterator;
+
 public:
     //
     // @@@ The class's public API below should NOT be modified @@@
     //
 
     // Constructor
-    Deque() : size(0), capacity(8)
+    Deque() : deq_array(Allocate(kMinCapacity)), size(0), front(0), capacity(kMinCapacity)
     {
-        deq_array = new T[8];
-        front = 0;
-        back = 7;
     }
     // Destructor
     ~Deque()
     {
+        Destroy();
         delete[] deq_array;
     };
+    // Copy and move
+    Deque(const Deque &other) : Deque()
+    {
+        for (size_t j = 0; j < other.size; j++)
+            PushBack(other.Item(j));
+    }
+    // A moved-from deque is empty and gets storage again on its next push
+    Deque(Deque &&other) noexcept : deq_array(other.deq_array), size(other.size), front(other.front), capacity(other.capacity)
+    {
+        other.deq_array = nullptr;
+        other.size = 0;
+        other.front = 0;
+        other.capacity = 0;
+    }
+    Deque &operator=(Deque other) noexcept
+    {
+        std::swap(deq_array, other.deq_array);
+        std::swap(size, other.size);
+        std::swap(front, other.front);
+        std::swap(capacity, other.capacity);
+        return *this;
+    }
 
     //
     // Capacity
@@ -43,21 +72,16 @@ public:
         return size;
     }
 
-    // Resize internal data structure to fit precisely the number of items and
-    // free unused memory
+    // Resize internal data structure to the smallest power of two that fits the
+    // number of items and free unused memory
     // Complexity: O(N)
     void ShrinkToFit()
     {
-        T *new_arr = new T[size];
-        for (size_t j = front; j < size; j++)
-        {
-            new_arr[j] = deq_array[(front + j) % capacity];
-        }
-        delete[] deq_array;
-        deq_array = new_arr;
-        capacity = size;
-        front = 0;
-        back = (size ==0 )? 0: size - 1;
+        size_t new_capacity = kMinCapacity;
+        while (new_capacity < size)
+            new_capacity *= 2;
+        if (new_capacity != capacity)
+            Reallocate(new_capacity);
     }
 
     //
@@ -70,21 +94,73 @@ public:
     {
         if (pos >= size)
             throw std::out_of_range("Index Out of Range");
-        return deq_array[(front + pos) % capacity];
+        return Item(pos);
     }
 
     // Return item at front of deque
     // Complexity: O(1)
     T &Front()
     {
-        return deq_array[front];
+        return Item(0);
     }
 
     // Return item at back of deque
     // Complexity: O(1)
     T &Back()
     {
-        return deq_array[back];
+        return Item(size - 1);
+    }
+
+    // Copy the @count items from pos @pos on into @out
+    // Complexity: O(count), one memcpy per contiguous span for trivially copyable T
+    void CopyOut(size_t pos, size_t count, T *out) const
+    {
+        if (pos > size || count > size - pos)
+            throw std::out_of_range("Index Out of Range");
+        ForEachSpan(pos, count, [&](T *span, size_t length, size_t done) {
+            if (std::is_trivially_copyable<T>::value)
+                std::memcpy(static_cast<void *>(out + done), span, length * sizeof(T));
+            else
+                std::copy(span, span + length, out + done);
+        });
+    }
+
+    //
+    // Iterators
+    //
+
+    // Random-access iterators from front to back, invalidated by any push, pop or reallocation
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    // Return iterator to the front item
+    // Complexity: O(1)
+    iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    // Return iterator past the back item
+    // Complexity: O(1)
+    iterator end() noexcept
+    {
+        return iterator(this, size);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, size);
+    }
+    const_iterator cend() const noexcept
+    {
+        return end();
     }
 
     //
@@ -92,106 +168,355 @@ public:
     //
 
     // Clear contents of deque (make it empty)
-    // Complexity: O(1)
+    // Complexity: O(1), plus one destructor call per item for non-trivial T
     void Clear(void) noexcept
     {
-        delete[] deq_array;
-        deq_array = new T[8];
+        Destroy();
         size = 0;
-        capacity = 8;
         front = 0;
-        back =7;
     }
 
     // Push item @value at front of deque
     // Complexity: O(1) amortized
     void PushFront(const T &value)
     {
-        if (size == capacity)
-            AddCapacity(); 
-        front = (front - 1 + capacity) % capacity;
-        deq_array[front] = value;
-        size++;
+        EmplaceFront(value);
+    }
+    void PushFront(T &&value)
+    {
+        EmplaceFront(std::move(value));
     }
 
     // Push item @value at back of deque
     // Complexity: O(1) amortized
     void PushBack(const T &value)
+    {
+        EmplaceBack(value);
+    }
+    void PushBack(T &&value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    // Construct an item from @args in place at front of deque, return it
+    // Complexity: O(1) amortized
+    template <typename... Args>
+    T &EmplaceFront(Args &&...args)
     {
         if (size == capacity)
-            AddCapacity(); 
-        back = (back + 1) % capacity;
-        deq_array[back] = value;
+        {
+            // @args may refer to an item of this deque, so the new item is made before the items move
+            T item(std::forward<Args>(args)...);
+            Reallocate(capacity ? capacity * 2 : kMinCapacity);
+            new (Slot(capacity - 1)) T(std::move(item));
+        }
+        else
+        {
+            new (Slot(capacity - 1)) T(std::forward<Args>(args)...);
+        }
+        front = (front - 1) & (capacity - 1);
         size++;
+        return Item(0);
     }
 
-    // Remove item at front of deque
+    // Construct an item from @args in place at back of deque, return it
     // Complexity: O(1) amortized
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args)
+    {
+        if (size == capacity)
+        {
+            T item(std::forward<Args>(args)...);
+            Reallocate(capacity ? capacity * 2 : kMinCapacity);
+            new (Slot(size)) T(std::move(item));
+        }
+        else
+        {
+            new (Slot(size)) T(std::forward<Args>(args)...);
+        }
+        size++;
+        return Item(size - 1);
+    }
+
+    // Remove item at front of deque
+    // Complexity: O(1)
     void PopFront()
     {
         if (size == 0)
             throw std::underflow_error("Deque is empty!");
-        front = (front + 1) % capacity;
+        Item(0).~T();
+        front = (front + 1) & (capacity - 1);
         size--;
-        if (size==0)
-        {
-            front = 0;
-            back =7;
-        }
-        
     }
 
     // Remove item at back of deque
-    // Complexity: O(1) amortized
+    // Complexity: O(1)
     void PopBack()
     {
         if (size == 0)
             throw std::underflow_error("Deque is empty!");
-        back = (back - 1 + capacity) % capacity;
+        Item(size - 1).~T();
         size--;
-        if (size==0)
+    }
+
+    // Push copies of the @count items at @items at back of deque, in order; @items must not point into it
+    // Complexity: O(count) amortized, one memcpy per contiguous span for trivially copyable T
+    void PushBackRange(const T *items, size_t count)
+    {
+        if (size + count > capacity)
         {
-            front = 0;
-            back =7;
+            size_t new_capacity = capacity ? capacity : kMinCapacity;
+            while (new_capacity < size + count)
+                new_capacity *= 2;
+            Reallocate(new_capacity);
+        }
+        if (std::is_trivially_copyable<T>::value)
+        {
+            ForEachSpan(size, count, [&](T *span, size_t length, size_t done) {
+                std::memcpy(static_cast<void *>(span), items + done, length * sizeof(T));
+            });
+            size += count;
+            return;
+        }
+        // One at a time, so that if a copy throws the items already pushed stay and the rest are not there
+        for (size_t j = 0; j < count; j++)
+        {
+            new (Slot(size)) T(items[j]);
+            size++;
         }
     }
 
+    // Remove @count items at front of deque
+    // Complexity: O(1) for trivially destructible T, O(count) otherwise
+    void PopFrontN(size_t count)
+    {
+        if (count > size)
+            throw std::underflow_error("Deque is empty!");
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            ForEachSpan(0, count, [](T *span, size_t length, size_t) {
+                for (size_t j = 0; j < length; j++)
+                    span[j].~T();
+            });
+        }
+        front = (front + count) & (capacity - 1);
+        size -= count;
+    }
+
 private:
     //
     // @@@ The class's internal members below can be modified @@@
     //
 
+    // Uninitialized room for one item: items are constructed in place as they
+    // are pushed and destroyed as they are popped, never default-constructed
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
     // Private member variables
-    T *deq_array;
+    Storage *deq_array;
     size_t size;
     size_t front;
-    size_t back;
-    size_t capacity;
+    size_t capacity;    // always a power of two, so that positions wrap with a mask
 
     // Private constants
-    // ...To be completed (if any)...
+    enum : size_t
+    {
+        kMinCapacity = 8
+    };
 
     // Private methods
-    void AddCapacity()
+    static Storage *Allocate(size_t count)
+    {
+        return new Storage[count];
+    }
+
+    // Address of the slot @pos places after the front (wrapping around)
+    void *Slot(size_t pos) const
+    {
+        return deq_array + ((front + pos) & (capacity - 1));
+    }
+
+    T &Item(size_t pos) const
     {
-        size_t new_capacity = capacity * 2;
-        T *new_arr = new T[new_capacity];
+        return *static_cast<T *>(Slot(pos));
+    }
 
-        for (size_t j = 0; j < size; j++)
+    // Call @fn(slot, length, done) on the at most two contiguous runs of slots that hold positions
+    // [@pos, @pos + @count) (the second one when they wrap around the end of the array), where @done is
+    // the number of positions in earlier runs; @pos + @count must not exceed the capacity
+    template <typename Fn>
+    void ForEachSpan(size_t pos, size_t count, Fn fn) const
+    {
+        if (count == 0)
+            return;
+        size_t first = (front + pos) & (capacity - 1);
+        size_t length = std::min(count, capacity - first);
+        fn(reinterpret_cast<T *>(deq_array + first), length, 0);
+        if (length < count)
+            fn(reinterpret_cast<T *>(deq_array), count - length, length);
+    }
+
+    void Destroy() noexcept
+    {
+        if (!std::is_trivially_destructible<T>::value)
         {
-            new_arr[j] = deq_array[(front + j) % capacity];
+            for (size_t j = 0; j < size; j++)
+                Item(j).~T();
         }
+    }
 
+    // Move the items, in order, to the front of a new array of @new_capacity slots
+    void Reallocate(size_t new_capacity)
+    {
+        Storage *new_arr = Allocate(new_capacity);
+        if (std::is_trivially_copyable<T>::value)
+        {
+            ForEachSpan(0, size, [&](T *span, size_t length, size_t done) {
+                std::memcpy(static_cast<void *>(new_arr + done), span, length * sizeof(T));
+            });
+            delete[] deq_array;
+            deq_array = new_arr;
+            capacity = new_capacity;
+            front = 0;
+            return;
+        }
+        size_t j = 0;
+        try
+        {
+            // Items move unless moving could throw and copying cannot, which keeps them intact on failure
+            for (; j < size; j++)
+                new (new_arr + j) T(std::move_if_noexcept(Item(j)));
+        }
+        catch (...)
+        {
+            while (j > 0)
+                reinterpret_cast<T *>(new_arr + --j)->~T();
+            delete[] new_arr;
+            throw;
+        }
+        Destroy();
         delete[] deq_array;
         deq_array = new_arr;
         capacity = new_capacity;
         front = 0;
-        back = size - 1;
     }
+
+    // Position in a deque plus the deque, so that it stays valid as the front moves around the array
+    template <bool Const>
+    class Iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const T *, T *>::type pointer;
+        typedef typename std::conditional<Const, const T &, T &>::type reference;
+
+        Iterator() : deque(nullptr), pos(0) {}
+        // An iterator converts to a const_iterator
+        Iterator(const Iterator<false> &other) : deque(other.deque), pos(other.pos) {}
+
+        reference operator*() const
+        {
+            return deque->Item(pos);
+        }
+        pointer operator->() const
+        {
+            return &deque->Item(pos);
+        }
+        reference operator[](difference_type n) const
+        {
+            return deque->Item(pos + n);
+        }
+
+        Iterator &operator++()
+        {
+            pos++;
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator old = *this;
+            pos++;
+            return old;
+        }
+        Iterator &operator--()
+        {
+            pos--;
+            return *this;
+        }
+        Iterator operator--(int)
+        {
+            Iterator old = *this;
+            pos--;
+            return old;
+        }
+        Iterator &operator+=(difference_type n)
+        {
+            pos += n;
+            return *this;
+        }
+        Iterator &operator-=(difference_type n)
+        {
+            pos -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n)
+        {
+            return it += n;
+        }
+        friend Iterator operator+(difference_type n, Iterator it)
+        {
+            return it += n;
+        }
+        friend Iterator operator-(Iterator it, difference_type n)
+        {
+            return it -= n;
+        }
+        friend difference_type operator-(const Iterator &a, const Iterator &b)
+        {
+            return static_cast<difference_type>(a.pos) - static_cast<difference_type>(b.pos);
+        }
+        friend bool operator==(const Iterator &a, const Iterator &b)
+        {
+            return a.pos == b.pos;
+        }
+        friend bool operator!=(const Iterator &a, const Iterator &b)
+        {
+            return a.pos != b.pos;
+        }
+        friend bool operator<(const Iterator &a, const Iterator &b)
+        {
+            return a.pos < b.pos;
+        }
+        friend bool operator>(const Iterator &a, const Iterator &b)
+        {
+            return a.pos > b.pos;
+        }
+        friend bool operator<=(const Iterator &a, const Iterator &b)
+        {
+            return a.pos <= b.pos;
+        }
+        friend bool operator>=(const Iterator &a, const Iterator &b)
+        {
+            return a.pos >= b.pos;
+        }
+
+    private:
+        friend class Deque;
+        friend class Iterator<true>;
+        typedef typename std::conditional<Const, const Deque *, Deque *>::type Owner;
+
+        Iterator(Owner deque, size_t pos) : deque(deque), pos(pos) {}
+
+        Owner deque;
+        size_t pos;
+    };
 };
-#endif 
+#endif
 //
 // Your implementation of the class should be located below
 //
 
-// ...To be completed..
\ No newline at end of file
+// ...To be completed..
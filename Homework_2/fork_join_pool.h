@@ -0,0 +1,281 @@
+#ifndef FORK_JOIN_POOL_H_
+#define FORK_JOIN_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "deque.h"
+#include "work_stealing_deque.h"
+
+// Fork-join thread pool on work stealing. Every worker owns a
+// WorkStealingDeque: tasks it spawns go to the bottom of its own deque and it
+// runs them newest first, while a worker that runs dry steals the oldest task
+// of a random other worker. With recursively split jobs the oldest task is the
+// biggest piece left, so one steal moves a lot of work and the load evens out
+// on its own however irregular the pieces are, which a single shared queue
+// with a fixed split cannot do. A thread waiting for its tasks runs other
+// tasks meanwhile (its own first), so tasks can spawn and wait for subtasks
+// without tying up a thread. Tasks spawned from outside the pool go to a
+// shared Deque behind a mutex that the workers check before stealing.
+class ForkJoinPool
+{
+public:
+    // Tasks spawned together and waited for together. Wait must be called
+    // before a group with spawned tasks goes out of scope.
+    class TaskGroup
+    {
+    public:
+        TaskGroup() : pending(0) {}
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+    private:
+        friend class ForkJoinPool;
+        std::atomic<size_t> pending;
+        std::mutex error_mutex;
+        std::exception_ptr error; // first exception a task of the group threw
+    };
+
+    // Constructor, @threads == 0 means one worker per hardware thread
+    explicit ForkJoinPool(unsigned threads) : queued(0), sleepers(0), stopping(false)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; i++)
+            workers.emplace_back(new Worker(this, i));
+        for (unsigned i = 0; i < threads; i++)
+            worker_threads.emplace_back([this, i] { WorkerLoop(workers[i].get()); });
+    }
+    // Destructor, finishes queued tasks then joins the workers
+    ~ForkJoinPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &thread : worker_threads)
+            thread.join();
+    }
+    ForkJoinPool(const ForkJoinPool &) = delete;
+    ForkJoinPool &operator=(const ForkJoinPool &) = delete;
+
+    // Return number of worker threads
+    size_t Size() const noexcept
+    {
+        return workers.size();
+    }
+
+    // Run @fn on the pool as part of @group
+    // Complexity: O(1) amortized
+    void Spawn(TaskGroup &group, std::function<void()> fn)
+    {
+        Task *task = new Task{std::move(fn), &group};
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Worker *self = Self();
+        if (self)
+        {
+            self->tasks.Push(task);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex);
+            injected.PushBack(task);
+        }
+        queued.fetch_add(1);
+        if (sleepers.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            wake.notify_one();
+        }
+    }
+
+    // Run tasks until every task of @group is done, then rethrow the first exception one of them threw
+    void Wait(TaskGroup &group)
+    {
+        Help(group);
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(group.error_mutex);
+            std::swap(error, group.error);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Call @fn(begin, end) on pieces covering [0, @n), halving the range until pieces have at most @grain
+    // items (@grain == 0 picks about 8 pieces per worker), and block until every piece is done
+    // Complexity: O(n / Size()) wall time if @fn is linear in its piece, whatever the cost of each item
+    void ParallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn)
+    {
+        if (grain == 0)
+            grain = std::max<size_t>(1, n / (8 * Size()));
+        TaskGroup group;
+        std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+            while (end - begin > grain)
+            {
+                size_t mid = begin + (end - begin) / 2;
+                Spawn(group, [&split, mid, end] { split(mid, end); });
+                end = mid;
+            }
+            fn(begin, end);
+        };
+        try
+        {
+            split(0, n);
+        }
+        catch (...)
+        {
+            // The pieces spawned so far refer to this frame
+            Help(group);
+            throw;
+        }
+        Wait(group);
+    }
+
+private:
+    struct Task
+    {
+        std::function<void()> fn;
+        TaskGroup *group;
+    };
+
+    struct Worker
+    {
+        Worker(ForkJoinPool *pool, unsigned index) : pool(pool), seed(2463534242u + index) {}
+
+        ForkJoinPool *pool;
+        uint32_t seed; // xorshift state for picking victims
+        WorkStealingDeque<Task *> tasks;
+    };
+
+    enum : unsigned
+    {
+        kIdleSpins = 64 // failed searches before an idle worker sleeps
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> worker_threads;
+    Deque<Task *> injected;
+    std::mutex inject_mutex;
+    std::atomic<size_t> queued;     // tasks spawned and not taken yet
+    std::atomic<unsigned> sleepers; // workers asleep on wake
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    // The worker of this pool running on the calling thread, nullptr for other threads
+    Worker *Self() const
+    {
+        Worker *current = Current();
+        return current && current->pool == this ? current : nullptr;
+    }
+
+    static Worker *&Current()
+    {
+        static thread_local Worker *current = nullptr;
+        return current;
+    }
+
+    // Take a task for @self (nullptr for a thread outside the pool): its own newest, else an injected one,
+    // else the oldest of some other worker, starting at a random one
+    bool FindTask(Worker *self, Task *&task)
+    {
+        if (self && self->tasks.Pop(task))
+            return true;
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex);
+            if (!injected.Empty())
+            {
+                task = injected.Front();
+                injected.PopFront();
+                return true;
+            }
+        }
+        size_t start = 0;
+        if (self)
+        {
+            self->seed ^= self->seed << 13;
+            self->seed ^= self->seed >> 17;
+            self->seed ^= self->seed << 5;
+            start = self->seed % workers.size();
+        }
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            Worker *victim = workers[(start + i) % workers.size()].get();
+            if (victim != self && victim->tasks.Steal(task))
+                return true;
+        }
+        return false;
+    }
+
+    void Run(Task *task)
+    {
+        queued.fetch_sub(1);
+        TaskGroup *group = task->group;
+        try
+        {
+            task->fn();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(group->error_mutex);
+            if (!group->error)
+                group->error = std::current_exception();
+        }
+        delete task;
+        // Last touch of the group: its waiter may return and free it right after
+        group->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Run tasks until every task of @group is done
+    void Help(TaskGroup &group)
+    {
+        Worker *self = Self();
+        while (group.pending.load(std::memory_order_acquire) > 0)
+        {
+            Task *task;
+            if (FindTask(self, task))
+                Run(task);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void WorkerLoop(Worker *self)
+    {
+        Current() = self;
+        unsigned idle = 0;
+        while (true)
+        {
+            Task *task;
+            if (FindTask(self, task))
+            {
+                Run(task);
+                idle = 0;
+                continue;
+            }
+            if (++idle < kIdleSpins)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleepers.fetch_add(1);
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            sleepers.fetch_sub(1);
+            if (stopping && queued.load() == 0)
+                return;
+            idle = 0;
+        }
+    }
+};
+#endif
@@ -0,0 +1,204 @@
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bounded hand-off queue between exactly one producer thread and one consumer
+// thread, without locks. Same circular buffer as Deque (uninitialized slots,
+// power-of-two capacity, mask indexing), with the two ends owned by different
+// threads: the producer only writes tail, the consumer only writes head, and
+// each publishes its end with a release store that the other side reads with
+// an acquire load. The ends sit on separate cache lines, each next to the
+// copy of the other end its owner last read, so that the threads only touch
+// each other's line when the ring looks full or empty.
+template <typename T>
+class SpscRing
+{
+public:
+    // Constructor, room for at least @capacity items (rounded up to a power of two)
+    explicit SpscRing(size_t capacity) : slots(nullptr), mask(0), head(0), cached_tail(0), tail(0), cached_head(0)
+    {
+        size_t rounded = 1;
+        while (rounded < capacity)
+            rounded *= 2;
+        slots = new Storage[rounded];
+        mask = rounded - 1;
+    }
+    // Destructor, destroys the items left in the ring
+    ~SpscRing()
+    {
+        for (size_t pos = head.load(std::memory_order_relaxed); pos != tail.load(std::memory_order_relaxed); pos++)
+            Item(pos).~T();
+        delete[] slots;
+    }
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    //
+    // Capacity
+    //
+
+    // Return number of items the ring holds when full
+    // Complexity: O(1)
+    size_t Capacity() const noexcept
+    {
+        return mask + 1;
+    }
+
+    // Return number of items in ring; exact only when neither thread is working on it, but always
+    // between 0 and Capacity() from any thread
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        // Head first: the tail read after it can only be further on, never behind it
+        size_t first = head.load(std::memory_order_acquire);
+        size_t last = tail.load(std::memory_order_acquire);
+        return std::min(last - first, Capacity());
+    }
+
+    // Return true if empty (same caveat as Size)
+    // Complexity: O(1)
+    bool Empty() const noexcept
+    {
+        return Size() == 0;
+    }
+
+    //
+    // Producer side
+    //
+
+    // Construct an item from @args at the tail, return false (and construct nothing) if full
+    // Complexity: O(1)
+    template <typename... Args>
+    bool TryEmplace(Args &&...args)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        if (Free(pos, 1) == 0)
+            return false;
+        new (slots + (pos & mask)) T(std::forward<Args>(args)...);
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Push item @value, return false if full
+    // Complexity: O(1)
+    bool TryPush(const T &value)
+    {
+        return TryEmplace(value);
+    }
+    bool TryPush(T &&value)
+    {
+        return TryEmplace(std::move(value));
+    }
+
+    // Push as many of the @count items at @items as fit, published at once; return how many.
+    // If a copy throws, none of the batch is pushed.
+    // Complexity: O(count)
+    size_t PushBatch(const T *items, size_t count)
+    {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        size_t n = std::min(count, Free(pos, count));
+        size_t i = 0;
+        try
+        {
+            for (; i < n; i++)
+                new (slots + ((pos + i) & mask)) T(items[i]);
+        }
+        catch (...)
+        {
+            // Nothing is published yet, so the consumer never saw these
+            while (i > 0)
+                Item(pos + --i).~T();
+            throw;
+        }
+        if (n > 0)
+            tail.store(pos + n, std::memory_order_release);
+        return n;
+    }
+
+    //
+    // Consumer side
+    //
+
+    // Move the item at the head into @value and remove it, return false if empty
+    // Complexity: O(1)
+    bool TryPop(T &value)
+    {
+        return PopBatch(&value, 1) == 1;
+    }
+
+    // Move up to @count items from the head into @out and remove them at once; return how many
+    // Complexity: O(count)
+    size_t PopBatch(T *out, size_t count)
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+        size_t n = std::min(count, Available(pos, count));
+        for (size_t i = 0; i < n; i++)
+        {
+            T &item = Item(pos + i);
+            out[i] = std::move(item);
+            item.~T();
+        }
+        if (n > 0)
+            head.store(pos + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+    // Padding that keeps what follows off the cache line of what precedes it
+    // (a padded layout instead of alignas, which plain new does not honor before C++17)
+    enum : size_t
+    {
+        kCacheLine = 64
+    };
+
+    // Shared, read-only after construction
+    Storage *slots;
+    size_t mask;
+    char pad0[kCacheLine];
+    // Consumer line: next item to pop, and the tail as the consumer last saw it
+    std::atomic<size_t> head;
+    size_t cached_tail;
+    char pad1[kCacheLine];
+    // Producer line: next slot to fill, and the head as the producer last saw it
+    std::atomic<size_t> tail;
+    size_t cached_head;
+    char pad2[kCacheLine];
+
+    T &Item(size_t pos) const
+    {
+        return *reinterpret_cast<T *>(slots + (pos & mask));
+    }
+
+    // Free slots from the producer's @pos, reloading the head only if the cached one leaves fewer than @wanted
+    size_t Free(size_t pos, size_t wanted)
+    {
+        size_t free = Capacity() - (pos - cached_head);
+        if (free < wanted)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            free = Capacity() - (pos - cached_head);
+        }
+        return free;
+    }
+
+    // Items ready from the consumer's @pos, reloading the tail only if the cached one shows fewer than @wanted
+    size_t Available(size_t pos, size_t wanted)
+    {
+        size_t ready = cached_tail - pos;
+        if (ready < wanted)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            ready = cached_tail - pos;
+        }
+        return ready;
+    }
+};
+#endif
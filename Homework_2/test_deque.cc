@@ -1,4 +1,9 @@
 #include "deque.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 // Test Case: Verify that a new deque is empty
@@ -53,6 +58,183 @@ TEST(DequeTest, CircularBehavior) {
     EXPECT_EQ(dq.Back(), 14);
     EXPECT_EQ(dq.Size(), 10);
 }
+// Item that counts how it was made and how many are alive
+struct Counted {
+    static int defaults, copies, moves, alive;
+    int value;
+    Counted() : value(0) { defaults++; alive++; }
+    explicit Counted(int v) : value(v) { alive++; }
+    Counted(const Counted &other) : value(other.value) { copies++; alive++; }
+    Counted(Counted &&other) noexcept : value(other.value) { moves++; alive++; }
+    Counted &operator=(const Counted &) = default;
+    ~Counted() { alive--; }
+    static void Reset() { defaults = copies = moves = alive = 0; }
+};
+int Counted::defaults = 0, Counted::copies = 0, Counted::moves = 0, Counted::alive = 0;
+
+// Test Case: Items are built in place, moved on growth, and destroyed when popped
+TEST(DequeTest, ConstructionsAndDestructions) {
+    Counted::Reset();
+    {
+        Deque<Counted> dq;
+        for (int i = 0; i < 100; i++) {
+            dq.EmplaceBack(i);
+        }
+        EXPECT_EQ(Counted::defaults, 0);
+        EXPECT_EQ(Counted::copies, 0);
+        EXPECT_EQ(Counted::alive, 100);
+        dq.PushFront(Counted(-1));
+        EXPECT_EQ(Counted::copies, 0);
+        EXPECT_EQ(dq.Front().value, -1);
+        EXPECT_EQ(dq[100].value, 99);
+        dq.PopFront();
+        dq.PopBack();
+        EXPECT_EQ(Counted::alive, 99);
+        dq.Clear();
+        EXPECT_EQ(Counted::alive, 0);
+        dq.EmplaceFront(7);
+        EXPECT_EQ(dq.Back().value, 7);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+// Test Case: Non-trivial and move-only items across growth and wrap-around
+TEST(DequeTest, NonTrivialItems) {
+    Deque<std::string> words;
+    for (int i = 0; i < 20; i++) {
+        words.PushBack(std::string(30, 'a' + i));
+        words.PushFront(std::to_string(i));
+    }
+    EXPECT_EQ(words.Size(), 40);
+    EXPECT_EQ(words.Front(), "19");
+    EXPECT_EQ(words[20], std::string(30, 'a'));
+    EXPECT_EQ(words.Back(), std::string(30, 'a' + 19));
+
+    Deque<std::unique_ptr<int>> owners;
+    for (int i = 0; i < 10; i++) {
+        owners.PushBack(std::unique_ptr<int>(new int(i)));
+        owners.EmplaceFront(new int(-i));
+    }
+    EXPECT_EQ(*owners.Front(), -9);
+    EXPECT_EQ(*owners.Back(), 9);
+    owners.PopFront();
+    EXPECT_EQ(*owners[0], -8);
+}
+
+// Test Case: Pushing an item of the deque itself when it has to grow
+TEST(DequeTest, PushOwnItem) {
+    Deque<std::string> dq;
+    for (int i = 0; i < 8; i++) {
+        dq.PushBack(std::to_string(i));
+    }
+    dq.PushBack(dq.Front());
+    dq.PushFront(dq.Back());
+    EXPECT_EQ(dq.Size(), 10);
+    EXPECT_EQ(dq.Back(), "0");
+    EXPECT_EQ(dq.Front(), "0");
+    EXPECT_EQ(dq[1], "0");
+}
+
+// Test Case: ShrinkToFit, copies and moves keep the items in order
+TEST(DequeTest, ShrinkCopyMove) {
+    Deque<int> dq;
+    for (int i = 0; i < 40; i++) {
+        dq.PushBack(i);
+    }
+    for (int i = 0; i < 35; i++) {
+        dq.PopFront();
+    }
+    dq.PushBack(40);
+    dq.PushFront(34);
+    dq.ShrinkToFit();
+    Deque<int> copy(dq);
+    Deque<int> moved(std::move(dq));
+    EXPECT_EQ(moved.Size(), 7);
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(moved[i], 34 + i);
+        EXPECT_EQ(copy[i], 34 + i);
+    }
+    EXPECT_TRUE(dq.Empty());
+    dq.PushBack(1);
+    EXPECT_EQ(dq.Front(), 1);
+    copy = moved;
+    copy.PushFront(0);
+    EXPECT_EQ(copy.Size(), 8);
+    EXPECT_EQ(moved.Size(), 7);
+}
+
+// Test Case: Iterators walk the items in order across the wrap-around and work with std:: algorithms
+TEST(DequeTest, Iterators) {
+    Deque<int> dq;
+    EXPECT_TRUE(dq.begin() == dq.end());
+    for (int i = 0; i < 5; i++) {
+        dq.PushBack(i);
+        dq.PushFront(-i - 1);
+    }
+    std::vector<int> seen(dq.begin(), dq.end());
+    EXPECT_EQ(seen, std::vector<int>({-5, -4, -3, -2, -1, 0, 1, 2, 3, 4}));
+    EXPECT_EQ(dq.end() - dq.begin(), 10);
+    EXPECT_EQ(std::accumulate(dq.begin(), dq.end(), 0), -5);
+    EXPECT_EQ(*(dq.begin() + 7), 2);
+    EXPECT_EQ(dq.begin()[9], 4);
+    EXPECT_EQ(*(dq.end() - 1), 4);
+
+    std::sort(dq.begin(), dq.end(), [](int a, int b) { return a > b; });
+    EXPECT_EQ(dq.Front(), 4);
+    EXPECT_EQ(dq.Back(), -5);
+    for (auto &item : dq) {
+        item *= 2;
+    }
+    EXPECT_EQ(dq[1], 6);
+
+    const Deque<int> &view = dq;
+    Deque<int>::const_iterator it = dq.begin();
+    EXPECT_TRUE(it == view.begin());
+    EXPECT_TRUE(view.cbegin() < dq.end());
+    EXPECT_EQ(std::count_if(view.begin(), view.end(), [](int v) { return v < 0; }), 5);
+    EXPECT_TRUE(std::is_sorted(view.begin(), view.end(), [](int a, int b) { return a > b; }));
+}
+
+// Test Case: Range push, copy out and pop across growth and wrap-around, for trivial and non-trivial items
+TEST(DequeTest, RangeOperations) {
+    Deque<int> dq;
+    std::vector<int> items(100);
+    std::iota(items.begin(), items.end(), 0);
+    dq.PushBackRange(items.data(), 6);
+    dq.PopFrontN(4);
+    dq.PushBackRange(items.data() + 6, 5);
+    EXPECT_EQ(dq.Size(), 7);
+    std::vector<int> out(7);
+    dq.CopyOut(0, 7, out.data());
+    EXPECT_EQ(out, std::vector<int>({4, 5, 6, 7, 8, 9, 10}));
+    dq.PushBackRange(items.data() + 11, 89);
+    EXPECT_EQ(dq.Size(), 96);
+    for (int i = 0; i < 96; i++) {
+        EXPECT_EQ(dq[i], i + 4);
+    }
+    dq.PopFrontN(90);
+    dq.CopyOut(2, 4, out.data());
+    EXPECT_EQ(out[0], 96);
+    EXPECT_EQ(out[3], 99);
+    EXPECT_THROW(dq.CopyOut(3, 4, out.data()), std::out_of_range);
+    EXPECT_THROW(dq.PopFrontN(7), std::underflow_error);
+    dq.PopFrontN(6);
+    EXPECT_TRUE(dq.Empty());
+
+    Deque<std::string> words;
+    std::vector<std::string> input = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+    words.PushFront("z");
+    words.PushBackRange(input.data(), input.size());
+    words.PopFrontN(3);
+    words.PushBackRange(input.data(), 3);
+    std::vector<std::string> copied(words.Size());
+    words.CopyOut(0, words.Size(), copied.data());
+    EXPECT_EQ(copied.front(), "c");
+    EXPECT_EQ(copied.back(), "c");
+    EXPECT_EQ(copied.size(), 11);
+    EXPECT_EQ(words[7], "j");
+}
+
 // Main function to run tests
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
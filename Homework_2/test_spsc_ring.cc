@@ -0,0 +1,164 @@
+#include "spsc_ring.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Test Case: Capacity is rounded up to a power of two and a full ring refuses items
+TEST(SpscRingTest, FullAndEmpty) {
+    SpscRing<int> ring(5);
+    EXPECT_EQ(ring.Capacity(), 8);
+    EXPECT_TRUE(ring.Empty());
+    int value = 0;
+    EXPECT_FALSE(ring.TryPop(value));
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(8));
+    EXPECT_EQ(ring.Size(), 8);
+    EXPECT_TRUE(ring.TryPop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(ring.TryPush(8));
+}
+
+// Test Case: Batches wrap around the end of the buffer and keep the order
+TEST(SpscRingTest, Batches) {
+    SpscRing<std::string> ring(8);
+    std::vector<std::string> in = {"a", "b", "c", "d", "e", "f"};
+    std::vector<std::string> out(8);
+    EXPECT_EQ(ring.PushBatch(in.data(), 6), 6);
+    EXPECT_EQ(ring.PopBatch(out.data(), 4), 4);
+    EXPECT_EQ(ring.PushBatch(in.data(), 6), 6);
+    EXPECT_EQ(ring.PushBatch(in.data(), 6), 0);
+    EXPECT_EQ(ring.PopBatch(out.data(), 8), 8);
+    EXPECT_EQ(out[0], "e");
+    EXPECT_EQ(out[1], "f");
+    EXPECT_EQ(out[2], "a");
+    EXPECT_EQ(out[7], "f");
+    EXPECT_TRUE(ring.Empty());
+}
+
+// Test Case: Move-only items, and items left in the ring are destroyed with it
+TEST(SpscRingTest, MoveOnlyItems) {
+    auto shared = std::make_shared<int>(1);
+    {
+        SpscRing<std::shared_ptr<int>> ring(4);
+        ring.TryPush(shared);
+        ring.TryEmplace(shared);
+        EXPECT_EQ(shared.use_count(), 3);
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+    SpscRing<std::unique_ptr<int>> owners(2);
+    EXPECT_TRUE(owners.TryPush(std::unique_ptr<int>(new int(7))));
+    std::unique_ptr<int> owner;
+    EXPECT_TRUE(owners.TryPop(owner));
+    EXPECT_EQ(*owner, 7);
+}
+
+// Test Case: One producer and one consumer thread see every item once and in order
+TEST(SpscRingTest, TwoThreads) {
+    SpscRing<long long> ring(64);
+    const long long count = 1000000;
+    std::thread producer([&]() {
+        for (long long i = 0; i < count;) {
+            if (ring.TryPush(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    long long expected = 0;
+    long long batch[16];
+    while (expected < count) {
+        size_t n = ring.PopBatch(batch, 16);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(batch[i], expected++);
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.Empty());
+}
+
+// Helper: counts live copies and throws on the copy number @throw_at
+struct Fragile {
+    static int alive;
+    static int copies;
+    static int throw_at;
+    Fragile() { alive++; }
+    Fragile(const Fragile &) {
+        if (++copies == throw_at) {
+            throw std::runtime_error("copy failed");
+        }
+        alive++;
+    }
+    Fragile &operator=(const Fragile &) = default;
+    ~Fragile() { alive--; }
+};
+int Fragile::alive = 0;
+int Fragile::copies = 0;
+int Fragile::throw_at = 0;
+
+// Test Case: A copy that throws in PushBatch leaves nothing of the batch behind
+TEST(SpscRingTest, PushBatchThrows) {
+    {
+        std::vector<Fragile> items(5);
+        SpscRing<Fragile> ring(8);
+        Fragile::copies = 0;
+        Fragile::throw_at = 4;
+        EXPECT_THROW(ring.PushBatch(items.data(), 5), std::runtime_error);
+        EXPECT_TRUE(ring.Empty());
+        EXPECT_EQ(Fragile::alive, 5);
+        Fragile::throw_at = 0;
+        EXPECT_EQ(ring.PushBatch(items.data(), 5), 5);
+        EXPECT_EQ(Fragile::alive, 10);
+    }
+    EXPECT_EQ(Fragile::alive, 0);
+}
+
+// Test Case: Size seen from a third thread stays within [0, Capacity] while both ends move
+TEST(SpscRingTest, SizeFromAnotherThread) {
+    SpscRing<int> ring(16);
+    std::atomic<bool> done(false);
+    std::thread producer([&]() {
+        for (int i = 0; i < 200000;) {
+            if (ring.TryPush(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&]() {
+        int value;
+        for (int i = 0; i < 200000;) {
+            if (ring.TryPop(value)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+    size_t largest = 0;
+    while (!done) {
+        largest = std::max(largest, ring.Size());
+        std::this_thread::yield();
+    }
+    producer.join();
+    consumer.join();
+    EXPECT_LE(largest, ring.Capacity());
+    EXPECT_TRUE(ring.Empty());
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+#include "fork_join_pool.h"
+#include "work_stealing_deque.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+// Test Case: The owner pops newest first, a thief steals oldest first
+TEST(WorkStealingDequeTest, OwnerAndThiefEnds) {
+    WorkStealingDeque<int> dq;
+    int value = 0;
+    EXPECT_FALSE(dq.Pop(value));
+    EXPECT_FALSE(dq.Steal(value));
+    for (int i = 0; i < 5; i++) {
+        dq.Push(i);
+    }
+    EXPECT_EQ(dq.Size(), 5);
+    EXPECT_TRUE(dq.Pop(value));
+    EXPECT_EQ(value, 4);
+    EXPECT_TRUE(dq.Steal(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(dq.Pop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(dq.Size(), 2);
+}
+
+// Test Case: Growing past the initial capacity keeps every item in order
+TEST(WorkStealingDequeTest, Growth) {
+    WorkStealingDeque<int> dq(2);
+    for (int i = 0; i < 1000; i++) {
+        dq.Push(i);
+    }
+    int value = 0;
+    for (int i = 0; i < 500; i++) {
+        EXPECT_TRUE(dq.Steal(value));
+        EXPECT_EQ(value, i);
+    }
+    for (int i = 999; i >= 500; i--) {
+        EXPECT_TRUE(dq.Pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(dq.Empty());
+}
+
+// Test Case: With the owner pushing and popping while thieves steal, every item is taken exactly once
+TEST(WorkStealingDequeTest, ConcurrentSteals) {
+    const int count = 200000;
+    WorkStealingDeque<int> dq;
+    std::vector<std::atomic<int>> taken(count);
+    for (auto &t : taken) {
+        t = 0;
+    }
+    std::atomic<bool> done(false);
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; t++) {
+        thieves.emplace_back([&]() {
+            int value;
+            while (!done || !dq.Empty()) {
+                if (dq.Steal(value)) {
+                    taken[value]++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    int value;
+    for (int i = 0; i < count; i++) {
+        dq.Push(i);
+        if (i % 3 == 0 && dq.Pop(value)) {
+            taken[value]++;
+        }
+    }
+    while (dq.Pop(value)) {
+        taken[value]++;
+    }
+    done = true;
+    for (auto &thief : thieves) {
+        thief.join();
+    }
+    for (int i = 0; i < count; i++) {
+        ASSERT_EQ(taken[i], 1) << "item " << i;
+    }
+}
+
+// Helper: Fibonacci by spawning one branch and computing the other, the usual fork-join shape
+static long long fib(ForkJoinPool &pool, int n) {
+    if (n < 2) {
+        return n;
+    }
+    long long left = 0;
+    ForkJoinPool::TaskGroup group;
+    pool.Spawn(group, [&]() { left = fib(pool, n - 1); });
+    long long right = fib(pool, n - 2);
+    pool.Wait(group);
+    return left + right;
+}
+
+// Test Case: Tasks that spawn and wait for subtasks do not deadlock and compute the right result
+TEST(ForkJoinPoolTest, NestedTasks) {
+    ForkJoinPool pool(4);
+    EXPECT_EQ(pool.Size(), 4);
+    EXPECT_EQ(fib(pool, 20), 6765);
+}
+
+// Test Case: ParallelFor covers every index exactly once, for any grain
+TEST(ForkJoinPoolTest, ParallelForCoversRange) {
+    ForkJoinPool pool(3);
+    for (size_t grain : {0, 1, 7, 100000}) {
+        std::vector<std::atomic<int>> hits(10007);
+        for (auto &h : hits) {
+            h = 0;
+        }
+        pool.ParallelFor(hits.size(), grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                hits[i]++;
+            }
+        });
+        for (size_t i = 0; i < hits.size(); i++) {
+            ASSERT_EQ(hits[i], 1) << "index " << i << " grain " << grain;
+        }
+    }
+    pool.ParallelFor(0, 0, [](size_t, size_t) {});
+}
+
+// Test Case: An exception thrown by a task comes out of Wait, and the pool keeps working
+TEST(ForkJoinPoolTest, Exceptions) {
+    ForkJoinPool pool(2);
+    ForkJoinPool::TaskGroup group;
+    std::atomic<int> ran(0);
+    for (int i = 0; i < 100; i++) {
+        pool.Spawn(group, [&, i]() {
+            ran++;
+            if (i == 42) {
+                throw std::runtime_error("task failed");
+            }
+        });
+    }
+    EXPECT_THROW(pool.Wait(group), std::runtime_error);
+    EXPECT_EQ(ran, 100);
+    EXPECT_THROW(pool.ParallelFor(1000, 1, [](size_t begin, size_t) {
+        if (begin == 500) {
+            throw std::out_of_range("piece failed");
+        }
+    }), std::out_of_range);
+    EXPECT_EQ(fib(pool, 15), 610);
+}
+
+// Main function to run tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+#ifndef WORK_STEALING_DEQUE_H_
+#define WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque: one owner thread pushes and pops at the
+// bottom (newest first, so it keeps working on what is hot in its cache),
+// any number of thief threads steal at the top (oldest first, so they take
+// the biggest pieces of a recursively split job). The owner only competes
+// with thieves for the last item, through a CAS on top; everything else is
+// plain loads and stores ordered as in Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (PPoPP 2013), except that their
+// fences are folded into the accesses to top and bottom (a release store
+// publishes a push, seq_cst orders bottom against top in Pop and Steal).
+// That costs the same on x86 and lets ThreadSanitizer, which does not model
+// atomic_thread_fence, see every synchronization the deque relies on.
+// Items are copied in and out of atomics, so T must be trivially copyable
+// (a pointer to a task, typically). The circular array grows like Deque's, by
+// doubling; thieves may still be reading an old array, so old arrays are kept
+// until the deque is destroyed (at most as much memory again as the last one).
+template <typename T>
+class WorkStealingDeque
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque items must be trivially copyable");
+
+    // Constructor, room for @capacity items before the first growth (rounded up to a power of two)
+    explicit WorkStealingDeque(size_t capacity = kMinCapacity) : top(0), bottom(0)
+    {
+        size_t rounded = kMinCapacity;
+        while (rounded < capacity)
+            rounded *= 2;
+        arrays.emplace_back(new Array(rounded));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    //
+    // Capacity
+    //
+
+    // Return number of items; exact only when no thread is working on the deque
+    // Complexity: O(1)
+    size_t Size() const noexcept
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    // Return true if empty (same caveat as Size)
+    // Complexity: O(1)
+    bool Empty() const noexcept
+    {
+        return Size() == 0;
+    }
+
+    //
+    // Owner side
+    //
+
+    // Push item @value at the bottom
+    // Complexity: O(1) amortized
+    void Push(T value)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->mask))
+            a = Grow(a, t, b);
+        a->Put(b, value);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // Take the item at the bottom into @value, return false if empty (or a thief got the last one)
+    // Complexity: O(1)
+    bool Pop(T &value)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        // Claim the bottom item before looking at top; a thief does the same the other way round
+        bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_seq_cst);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = a->Get(b);
+        if (t == b)
+        {
+            // Last item: whoever moves top first gets it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    //
+    // Thief side
+    //
+
+    // Take the item at the top into @value, return false if empty or another thread took it first
+    // Complexity: O(1)
+    bool Steal(T &value)
+    {
+        int64_t t = top.load(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_seq_cst);
+        if (t >= b)
+            return false;
+        Array *a = array.load(std::memory_order_acquire);
+        value = a->Get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    enum : size_t
+    {
+        kMinCapacity = 64
+    };
+
+    struct Array
+    {
+        explicit Array(size_t capacity) : mask(capacity - 1), items(new std::atomic<T>[capacity]) {}
+
+        T Get(int64_t pos) const
+        {
+            return items[static_cast<size_t>(pos) & mask].load(std::memory_order_relaxed);
+        }
+
+        void Put(int64_t pos, T value)
+        {
+            items[static_cast<size_t>(pos) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    // top and bottom only grow (bottom dips by one while the owner pops), signed so that bottom - 1 < top
+    // reads as empty
+    std::atomic<int64_t> top;
+    std::atomic<int64_t> bottom;
+    std::atomic<Array *> array;
+    std::vector<std::unique_ptr<Array>> arrays; // owner only: the current array and the ones it replaced
+
+    // Copy items [@t, @b) into an array twice the size of @old and publish it
+    Array *Grow(Array *old, int64_t t, int64_t b)
+    {
+        arrays.emplace_back(new Array(2 * (old->mask + 1)));
+        Array *grown = arrays.back().get();
+        for (int64_t pos = t; pos < b; pos++)
+            grown->Put(pos, old->Get(pos));
+        array.store(grown, std::memory_order_release);
+        return grown;
+    }
+};
+#endif